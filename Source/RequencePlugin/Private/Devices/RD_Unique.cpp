@@ -1,19 +1,19 @@
 #include "RD_Unique.h"
 
-void URD_Unique::LoadDefaultPhysicalData(FSDLDeviceInfo Data)
+void URD_Unique::LoadDefaultPhysicalData(const FSDLDeviceInfo& Data)
 {
 	if (bHasPhysicalData) return;
 
-	PhysicalAxises.Empty();
-	PhysicalButtons.Empty();
+	PhysicalAxises.Empty(Data.Axises.Num());
+	PhysicalButtons.Empty(Data.Buttons.Num());
 
-	for (auto& Axises : Data.Axises)
+	for (const FKey& Axis : Data.Axises)
 	{
-		PhysicalAxises.Add(FRequencePhysicalAxis(Axises.Value.ToString()));
+		PhysicalAxises.Add(FRequencePhysicalAxis(Axis.ToString()));
 	}
-	for (auto& Buttons : Data.Buttons)
+	for (const FKey& Button : Data.Buttons)
 	{
-		PhysicalButtons.Add(Buttons.Value.ToString());
+		PhysicalButtons.Add(Button.ToString());
 	}
 
 	//todo: add hats
@@ -21,33 +21,39 @@ void URD_Unique::LoadDefaultPhysicalData(FSDLDeviceInfo Data)
 	bHasPhysicalData = true;
 }
 
-FRequencePhysicalAxis URD_Unique::GetPhysicalAxisByName(FString PhysicalAxisName)
+const FRequencePhysicalAxis* URD_Unique::FindPhysicalAxis(const FString& PhysicalAxisName) const
 {
-	for (FRequencePhysicalAxis pa : PhysicalAxises) 
+	for (const FRequencePhysicalAxis& pa : PhysicalAxises)
 	{
-		if (pa.Axis == PhysicalAxisName) { return pa; }
+		if (pa.Axis == PhysicalAxisName) { return &pa; }
 	}
+	return nullptr;
+}
 
-	return FRequencePhysicalAxis();
+FRequencePhysicalAxis URD_Unique::GetPhysicalAxisByName(const FString& PhysicalAxisName)
+{
+	const FRequencePhysicalAxis* Found = FindPhysicalAxis(PhysicalAxisName);
+	return Found ? *Found : FRequencePhysicalAxis();
 }
 
-FRequencePhysicalAxis URD_Unique::GetPhysicalAxisByCompactifiedName(FString CompressedAxisName) 
+FRequencePhysicalAxis URD_Unique::GetPhysicalAxisByCompactifiedName(const FString& CompressedAxisName) 
 {
-	for (FRequencePhysicalAxis pa : PhysicalAxises)
+	//Physical axises are named after their key, so the compact strings are cached per key.
+	for (const FRequencePhysicalAxis& pa : PhysicalAxises)
 	{
-		if (CompactifyKeyString(pa.Axis) == CompressedAxisName) { return pa; }
+		if (GetCompactKeyString(FKey(*pa.Axis)) == CompressedAxisName) { return pa; }
 	}
 
 	return FRequencePhysicalAxis();
 }
 
-bool URD_Unique::UpdatePhysicalAxisDataPoints(FString AxisName, TArray<FVector2D> DataPoints)
+bool URD_Unique::UpdatePhysicalAxisDataPoints(const FString& AxisName, const TArray<FVector2D>& DataPoints)
 {
-	for (int i = 0; i < PhysicalAxises.Num(); i++) 
+	for (FRequencePhysicalAxis& pa : PhysicalAxises)
 	{
-		if (PhysicalAxises[i].Axis == AxisName) {
-			PhysicalAxises[i].DataPoints = DataPoints;
-			this->Updated = true;
+		if (pa.Axis == AxisName) {
+			pa.DataPoints = DataPoints;
+			MarkBindingsChanged();
 			return true;
 		}
 	}
@@ -55,13 +61,13 @@ bool URD_Unique::UpdatePhysicalAxisDataPoints(FString AxisName, TArray<FVector2D
 	return false;
 }
 
-bool URD_Unique::UpdatePhysicalAxis(FRequencePhysicalAxis toUpdate)
+bool URD_Unique::UpdatePhysicalAxis(const FRequencePhysicalAxis& toUpdate)
 {
-	for (int i = 0; i < PhysicalAxises.Num(); i++)
+	for (FRequencePhysicalAxis& pa : PhysicalAxises)
 	{
-		if (PhysicalAxises[i].Axis == toUpdate.Axis) {
-			PhysicalAxises[i] = toUpdate;
-			this->Updated = true;
+		if (pa.Axis == toUpdate.Axis) {
+			pa = toUpdate;
+			MarkBindingsChanged();
 			return true;
 		}
 	}
@@ -71,15 +77,19 @@ bool URD_Unique::UpdatePhysicalAxis(FRequencePhysicalAxis toUpdate)
 TSharedPtr<FJsonObject> URD_Unique::GetDeviceAsJson()
 {
 	TSharedPtr<FJsonObject> Preset = URequenceDevice::GetDeviceAsJson();
+	Preset->SetStringField("HardwareID", HardwareID);
+	Preset->SetNumberField("HardwareOrdinal", HardwareOrdinal);
 
 	TArray<TSharedPtr<FJsonValue>> axises;
-	for (FRequencePhysicalAxis pa : PhysicalAxises)
+	axises.Reserve(PhysicalAxises.Num());
+	for (const FRequencePhysicalAxis& pa : PhysicalAxises)
 	{
 		TSharedPtr<FJsonObject> JSONPhysicalAxis = MakeShareable(new FJsonObject);
 		JSONPhysicalAxis->SetStringField("Axis", pa.Axis);
 
 		TArray<TSharedPtr<FJsonValue>> datapoints;
-		for (FVector2D dp : pa.DataPoints) {
+		datapoints.Reserve(pa.DataPoints.Num());
+		for (const FVector2D& dp : pa.DataPoints) {
 			TSharedPtr<FJsonObject> datapoint = MakeShareable(new FJsonObject);
 			datapoint->SetNumberField("X", dp.X);
 			datapoint->SetNumberField("Y", dp.Y);
@@ -89,6 +99,8 @@ TSharedPtr<FJsonObject> URD_Unique::GetDeviceAsJson()
 		}
 		JSONPhysicalAxis->SetArrayField("CurveDataPoints", datapoints);
 		JSONPhysicalAxis->SetStringField("InputRange", EnumToString<ERequencePAInputRange>("ERequencePAInputRange", pa.InputRange));
+		JSONPhysicalAxis->SetNumberField("DeadZone", pa.DeadZone);
+		JSONPhysicalAxis->SetNumberField("ChangeThreshold", pa.ChangeThreshold);
 
 		TSharedRef<FJsonValueObject> PhysicalAxisValue = MakeShareable(new FJsonValueObject(JSONPhysicalAxis));
 		axises.Add(PhysicalAxisValue);
@@ -98,18 +110,50 @@ TSharedPtr<FJsonObject> URD_Unique::GetDeviceAsJson()
 	return Preset;
 }
 
-FRequenceSaveObjectDevice URD_Unique::ToStruct()
+void URD_Unique::SetJsonAsPhysicalAxises(const TArray<TSharedPtr<FJsonValue>>& _PhysicalAxises)
+{
+	PhysicalAxises.Empty(_PhysicalAxises.Num());
+	for (const TSharedPtr<FJsonValue>& Value : _PhysicalAxises)
+	{
+		const TSharedPtr<FJsonObject>& JsonPhysicalAxis = Value->AsObject();
+		if (!JsonPhysicalAxis.IsValid()) { continue; }
+
+		FRequencePhysicalAxis pa(JsonPhysicalAxis->GetStringField(TEXT("Axis")));
+		for (const TSharedPtr<FJsonValue>& JsonDataPoint : JsonPhysicalAxis->GetArrayField(TEXT("CurveDataPoints")))
+		{
+			const TSharedPtr<FJsonObject>& datapoint = JsonDataPoint->AsObject();
+			if (datapoint.IsValid()) { pa.DataPoints.Add(FVector2D(datapoint->GetNumberField(TEXT("X")), datapoint->GetNumberField(TEXT("Y")))); }
+		}
+		pa.InputRange = StringToEnum<ERequencePAInputRange>("ERequencePAInputRange", JsonPhysicalAxis->GetStringField(TEXT("InputRange")));
+
+		//Older presets don't have these.
+		double Number = 0.0;
+		if (JsonPhysicalAxis->TryGetNumberField(TEXT("DeadZone"), Number)) { pa.DeadZone = Number; }
+		if (JsonPhysicalAxis->TryGetNumberField(TEXT("ChangeThreshold"), Number)) { pa.ChangeThreshold = Number; }
+
+		PhysicalAxises.Add(MoveTemp(pa));
+	}
+	bHasPhysicalData = PhysicalAxises.Num() > 0;
+	MarkBindingsChanged();
+}
+
+FRequenceSaveObjectDevice URD_Unique::ToStruct() const
 {
 	FRequenceSaveObjectDevice toReturn = URequenceDevice::ToStruct();
+	toReturn.HardwareID = HardwareID;
+	toReturn.HardwareOrdinal = HardwareOrdinal;
 	toReturn.PhysicalAxises = PhysicalAxises;
 	toReturn.PhysicalButtons = PhysicalButtons;
 	return toReturn;
 }
 
-void URD_Unique::FromStruct(FRequenceSaveObjectDevice StructIn, URequence* _RequenceRef, TArray<FString> FullAxisList, TArray<FString> FullActionList)
+void URD_Unique::FromStruct(FRequenceSaveObjectDevice&& StructIn, URequence* _RequenceRef, const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList)
 {
-	URequenceDevice::FromStruct(StructIn, _RequenceRef, FullAxisList, FullActionList);
-	PhysicalAxises = StructIn.PhysicalAxises;
-	PhysicalButtons = StructIn.PhysicalButtons;
+	//The base only takes the binding arrays, the physical data is still there.
+	URequenceDevice::FromStruct(MoveTemp(StructIn), _RequenceRef, FullAxisList, FullActionList);
+	HardwareID = MoveTemp(StructIn.HardwareID);
+	HardwareOrdinal = StructIn.HardwareOrdinal;
+	PhysicalAxises = MoveTemp(StructIn.PhysicalAxises);
+	PhysicalButtons = MoveTemp(StructIn.PhysicalButtons);
 	bHasPhysicalData = true;
 }
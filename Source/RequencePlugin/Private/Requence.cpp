@@ -9,6 +9,8 @@
 #include "FileHelper.h"
 #include "RequencePlugin.h"
 #include "RD_Unique.h"
+#include "RequenceStats.h"
+#include "RequenceKeyTypes.h"
 
 URequence::URequence() 
 {
@@ -43,7 +45,7 @@ bool URequence::LoadUnrealInput()
 		Actions.Add(FRIAc);
 
  		//Grab device
-		ERequenceDeviceType erdt = URequenceDevice::GetDeviceTypeByKeyString(FRIAc.KeyString);
+		ERequenceDeviceType erdt = FRequenceKeyTypes::Get(FRIAc.Key);
 		URequenceDevice* device = GetDeviceByType(erdt);
 
 		if (IsValid(device)) 
@@ -52,7 +54,7 @@ bool URequence::LoadUnrealInput()
 		} 
 		else
 		{	//Create new device and add key.
-			device = CreateDevice(FRIAc.KeyString);
+			device = CreateDeviceByType(erdt);
 			device->AddAction(FRIAc);
 		}
 	}
@@ -65,7 +67,7 @@ bool URequence::LoadUnrealInput()
 		Axises.Add(FRIAx);
 
 		//Grab device
-		ERequenceDeviceType erdt = URequenceDevice::GetDeviceTypeByKeyString(FRIAx.KeyString);
+		ERequenceDeviceType erdt = FRequenceKeyTypes::Get(FRIAx.Key);
 		URequenceDevice* device = GetDeviceByType(erdt);
 		if (IsValid(device))
 		{	//Add to current device
@@ -73,21 +75,17 @@ bool URequence::LoadUnrealInput()
 		}
 		else
 		{	//Create new device and add key.
-			device = CreateDevice(FRIAx.KeyString);
+			device = CreateDeviceByType(erdt);
 			device->AddAxis(FRIAx);
 		}
 	}
 
 	FillFullAxisActionLists();
 
-	//Add empty bindings so every device has all the mappings. Also sort alphabetically.
+	//Add empty bindings so every device has all the mappings. Devices keep them sorted.
 	for (URequenceDevice* d : Devices)
 	{
 		d->AddAllEmpty(FullAxisList, FullActionList);
-
-		//Sort it!
-		d->SortAlphabetically();
-		d->CompactifyAllKeyNames();
 	}
 
 	RequenceInputDevicesUpdated();
@@ -102,46 +100,10 @@ bool URequence::SaveUnrealInput(bool Force)
 
 	if (HasUpdated() || Force)
 	{
-		//Todo: Store a backup of these mappings - only empty them after the fact when its safe.
-		Settings->ActionMappings.Empty();
-		Settings->AxisMappings.Empty();
-
-		for (URequenceDevice* d : Devices)
-		{
-			for (FRequenceInputAction ac : d->Actions)
-			{
-				if (ac.Key != FKey())
-				{
-					FInputActionKeyMapping NewAction;
-					NewAction.ActionName = FName(*ac.ActionName);
-					NewAction.Key = ac.Key;
-					NewAction.bShift = ac.bShift;
-					NewAction.bCtrl = ac.bCmd;
-					NewAction.bAlt = ac.bAlt;
-					NewAction.bCmd = ac.bCmd;
-					Settings->ActionMappings.Add(NewAction);
-				}
-			}
-
-			for (FRequenceInputAxis ax : d->Axises)
-			{
-				if (ax.Key != FKey())
-				{
-					FInputAxisKeyMapping NewAxis;
-					NewAxis.AxisName = FName(*ax.AxisName);
-					NewAxis.Key = ax.Key;
-					NewAxis.Scale = ax.Scale;
-					Settings->AxisMappings.Add(NewAxis);
-				}
-			}
-		}
-
+		//Writes exactly what is applied, so the next apply can keep patching.
+		FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
+		ApplyAllMappings(*Settings, RPM.InputDevice.Get());
 		Settings->SaveKeyMappings();
-
-		for (TObjectIterator<UPlayerInput> It; It; ++It)
-		{
-			It->ForceRebuildingKeyMaps(true);
-		}
 		return true;
 	}
 
@@ -150,6 +112,7 @@ bool URequence::SaveUnrealInput(bool Force)
 
 bool URequence::LoadInput(bool ForceDefault)
 {
+	SCOPE_CYCLE_COUNTER(STAT_Requence_LoadInput);
 	ClearDevicesAndAxises();
 
 	URequenceSaveObject* RSO_Instance = Cast<URequenceSaveObject>(UGameplayStatics::CreateSaveGameObject(URequenceSaveObject::StaticClass()));
@@ -170,21 +133,24 @@ bool URequence::LoadInput(bool ForceDefault)
 			return LoadInput(true);
 		}
 
-		//If we have enough devices in here, fill it up.
+		//If we have enough devices in here, fill it up. The save object is thrown away after, so the devices take over its arrays.
 		FillFullAxisActionLists();
-		for (FRequenceSaveObjectDevice SavedDevice : RSO_Instance->Devices)
+		Devices.Reserve(RSO_Instance->Devices.Num());
+		for (FRequenceSaveObjectDevice& SavedDevice : RSO_Instance->Devices)
 		{
 			if (SavedDevice.DeviceType == ERequenceDeviceType::RDT_Unique)
 			{
 				URD_Unique* newDevice = NewObject<URD_Unique>(this, URD_Unique::StaticClass());
-				newDevice->FromStruct(SavedDevice, this, FullAxisList, FullActionList);
+				newDevice->FromStruct(MoveTemp(SavedDevice), this, FullAxisList, FullActionList);
 				Devices.Add(newDevice);
+				DeviceRegistry.Add(newDevice);
 			}
 			else 
 			{
 				URequenceDevice* newDevice = NewObject<URequenceDevice>(this, URequenceDevice::StaticClass());
-				newDevice->FromStruct(SavedDevice, this, FullAxisList, FullActionList);
+				newDevice->FromStruct(MoveTemp(SavedDevice), this, FullAxisList, FullActionList);
 				Devices.Add(newDevice);
+				DeviceRegistry.Add(newDevice);
 			}
 		}
 		if (Devices.Num() > 0)
@@ -198,9 +164,11 @@ bool URequence::LoadInput(bool ForceDefault)
 
 bool URequence::SaveInput()
 {
+	SCOPE_CYCLE_COUNTER(STAT_Requence_SaveInput);
 	URequenceSaveObject* RSO_Instance = Cast<URequenceSaveObject>(UGameplayStatics::CreateSaveGameObject(URequenceSaveObject::StaticClass()));
 	RSO_Instance->RequenceVersion = Version;
 
+	RSO_Instance->Devices.Reserve(Devices.Num());
 	for (URequenceDevice* Device : Devices)
 	{
 		if (Device->DeviceType == ERequenceDeviceType::RDT_Unique) 
@@ -221,57 +189,166 @@ bool URequence::SaveInput()
 
 bool URequence::ApplyAxisesAndActions(bool Force)
 {
+	SCOPE_CYCLE_COUNTER(STAT_Requence_ApplyAxisesAndActions);
 	UInputSettings* Settings = GetMutableDefault<UInputSettings>();
-	if (!Settings) { return false;
+	if (!Settings) { return false; }
+
+	FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
+
+	if (Force || !bHasAppliedMappings)
+	{
+		ApplyAllMappings(*Settings, RPM.InputDevice.Get());
 	}
+	else if (!ApplyChangedMappings(*Settings, RPM.InputDevice.Get()))
+	{
+		return false;
+	}
+	return RPM.InputDevice.IsValid();
+}
 
-	if (HasUpdated() || Force)
+//Hands the physical axis settings of a unique device to the input device, without a round trip through the save file.
+static void PushPhysicalData(const URequenceDevice& Device, RequenceInputDevice* InputDevice)
+{
+	const URD_Unique* Unique = Cast<URD_Unique>(&Device);
+	if (InputDevice && Unique && Unique->bHasPhysicalData)
 	{
-		//Todo: Store a backup of these mappings - only empty them after the fact when its safe.
-		Settings->ActionMappings.Empty();
-		Settings->AxisMappings.Empty();
+		InputDevice->SetPhysicalAxises(Unique->DeviceString, Unique->PhysicalAxises);
+	}
+}
 
-		for (URequenceDevice* d : Devices)
+//Splits two versions of a mapping list into what was removed and what was added.
+template<typename MappingType>
+static void DiffMappings(const TArray<MappingType>& Old, const TArray<MappingType>& New, TArray<MappingType>& OutRemoved, TArray<MappingType>& OutAdded)
+{
+	TBitArray<> Matched;
+	Matched.Init(false, New.Num());
+
+	//Bindings keep their order, so both lists mostly line up and we only search where they diverge.
+	int32 Next = 0;
+	for (const MappingType& Mapping : Old)
+	{
+		int32 Found = INDEX_NONE;
+		if (Next < New.Num() && !Matched[Next] && New[Next] == Mapping)
+		{
+			Found = Next;
+		}
+		else
 		{
-			for (FRequenceInputAction ac : d->Actions)
+			for (int32 i = 0; i < New.Num(); i++)
 			{
-				if (ac.Key != FKey())
+				if (!Matched[i] && New[i] == Mapping) 
 				{
-					FInputActionKeyMapping NewAction;
-					NewAction.ActionName = FName(*ac.ActionName);
-					NewAction.Key = ac.Key;
-					NewAction.bShift = ac.bShift;
-					NewAction.bCtrl = ac.bCmd;
-					NewAction.bAlt = ac.bAlt;
-					NewAction.bCmd = ac.bCmd;
-					Settings->ActionMappings.Add(NewAction);
+					Found = i;
+					break;
 				}
 			}
+		}
 
-			for (FRequenceInputAxis ax : d->Axises)
-			{
-				if (ax.Key != FKey())
-				{
-					FInputAxisKeyMapping NewAxis;
-					NewAxis.AxisName = FName(*ax.AxisName);
-					NewAxis.Key = ax.Key;
-					NewAxis.Scale = ax.Scale;
-					Settings->AxisMappings.Add(NewAxis);
-				}
-			}
+		if (Found == INDEX_NONE)
+		{
+			OutRemoved.Add(Mapping);
+			continue;
 		}
-		for (TObjectIterator<UPlayerInput> It; It; ++It)
+		Matched[Found] = true;
+		Next = Found + 1;
+	}
+
+	for (int32 i = 0; i < New.Num(); i++)
+	{
+		if (!Matched[i]) { OutAdded.Add(New[i]); }
+	}
+}
+
+//Removes one copy of each removed mapping and appends the added ones. Duplicates are kept, two devices can bind the same mapping.
+template<typename MappingType>
+static void PatchMappings(TArray<MappingType>& Mappings, const TArray<MappingType>& Removed, const TArray<MappingType>& Added)
+{
+	for (const MappingType& Mapping : Removed) { Mappings.RemoveSingle(Mapping); }
+	Mappings.Append(Added);
+}
+
+void URequence::ApplyAllMappings(UInputSettings& Settings, RequenceInputDevice* InputDevice)
+{
+	//Todo: Store a backup of these mappings - only empty them after the fact when its safe.
+	const FRequenceEngineMappings& Mappings = GetEngineMappings();
+	Settings.ActionMappings = Mappings.Actions;
+	Settings.AxisMappings = Mappings.Axises;
+
+	AppliedMappings.Reset();
+	for (URequenceDevice* d : Devices)
+	{
+		AppliedMappings.Add(d, d->GetEngineMappings());
+		PushPhysicalData(*d, InputDevice);
+	}
+	bHasAppliedMappings = true;
+
+	for (TObjectIterator<UPlayerInput> It; It; ++It)
+	{
+		It->ForceRebuildingKeyMaps(true);
+	}
+}
+
+bool URequence::ApplyChangedMappings(UInputSettings& Settings, RequenceInputDevice* InputDevice)
+{
+	bool bChanged = false;
+	TArray<FInputActionKeyMapping> RemovedActions, AddedActions;
+	TArray<FInputAxisKeyMapping> RemovedAxises, AddedAxises;
+
+	//Devices that are gone take their mappings with them.
+	TSet<URequenceDevice*> LiveDevices;
+	LiveDevices.Reserve(Devices.Num());
+	LiveDevices.Append(Devices);
+	for (auto It = AppliedMappings.CreateIterator(); It; ++It)
+	{
+		URequenceDevice* Device = It.Key().Get();
+		if (Device == nullptr || !LiveDevices.Contains(Device))
 		{
-			It->ForceRebuildingKeyMaps(true);
+			RemovedActions.Append(It.Value()->Actions);
+			RemovedAxises.Append(It.Value()->Axises);
+			It.RemoveCurrent();
+			bChanged = true;
 		}
+	}
 
-		FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
-		if (!RPM.InputDevice.IsValid()) { return false; }
-		RPM.InputDevice->LoadRequenceDeviceProperties();
+	for (URequenceDevice* d : Devices)
+	{
+		//Devices hand out the same compiled mappings until they change.
+		TSharedRef<const FRequenceEngineMappings> Current = d->GetEngineMappings();
+		TSharedPtr<const FRequenceEngineMappings>& Applied = AppliedMappings.FindOrAdd(d);
+		if (Applied.Get() == &Current.Get()) { continue; }
 
-		return true;
+		if (Applied.IsValid())
+		{
+			DiffMappings(Applied->Actions, Current->Actions, RemovedActions, AddedActions);
+			DiffMappings(Applied->Axises, Current->Axises, RemovedAxises, AddedAxises);
+		}
+		else
+		{
+			AddedActions.Append(Current->Actions);
+			AddedAxises.Append(Current->Axises);
+		}
+		Applied = Current;
+
+		PushPhysicalData(*d, InputDevice);
+		bChanged = true;
 	}
-	return false;
+
+	if (RemovedActions.Num() + AddedActions.Num() + RemovedAxises.Num() + AddedAxises.Num() == 0) { return bChanged; }
+
+	PatchMappings(Settings.ActionMappings, RemovedActions, AddedActions);
+	PatchMappings(Settings.AxisMappings, RemovedAxises, AddedAxises);
+
+	//Only players that exist hold key maps, new ones copy the settings when they are created. Each patched player rebuilds its key maps lazily.
+	//Players are patched like the settings, not through Add/RemoveActionMapping which dedup, so they end up where ApplyAllMappings would leave them.
+	for (TObjectIterator<UPlayerInput> It; It; ++It)
+	{
+		if (It->IsTemplate() || It->IsPendingKill()) { continue; }
+
+		PatchMappings(It->ActionMappings, RemovedActions, AddedActions);
+		PatchMappings(It->AxisMappings, RemovedAxises, AddedAxises);
+		It->ForceRebuildingKeyMaps(false);
+	}
+	return true;
 }
 
 void URequence::OnGameStartup()
@@ -288,8 +365,37 @@ void URequence::OnGameStartup()
 	return;
 }
 
+//Whether any key bound on Device has DeviceName in its name. KeyName is scratch space, reused across calls.
+static bool HasKeyNamedAfter(const URequenceDevice& Device, const FString& DeviceName, FString& KeyName)
+{
+	for (const FRequenceInputAction& ac : Device.Actions)
+	{
+		KeyName.Reset();
+		ac.Key.GetFName().AppendString(KeyName);
+		if (KeyName.Contains(DeviceName)) { return true; }
+	}
+	for (const FRequenceInputAxis& ax : Device.Axises)
+	{
+		KeyName.Reset();
+		ax.Key.GetFName().AppendString(KeyName);
+		if (KeyName.Contains(DeviceName)) { return true; }
+	}
+	return false;
+}
+
+//First unique device of Candidates that no connected unit took yet, nullptr when there is none.
+static URequenceDevice* FindUnclaimedUnique(TArrayView<URequenceDevice* const> Candidates, const TSet<URequenceDevice*>& Claimed)
+{
+	for (URequenceDevice* Device : Candidates)
+	{
+		if (Device->DeviceType == ERequenceDeviceType::RDT_Unique && !Claimed.Contains(Device)) { return Device; }
+	}
+	return nullptr;
+}
+
 void URequence::RequenceInputDevicesUpdated()
 {
+	SCOPE_CYCLE_COUNTER(STAT_Requence_InputDevicesUpdated);
 	for (URequenceDevice* URDevice : Devices) {
 		URDevice->Connected = false;
 	}
@@ -297,43 +403,61 @@ void URequence::RequenceInputDevicesUpdated()
 	FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
 	if (!RPM.InputDevice.IsValid()) { return; }
 
-	for (FSDLDeviceInfo RIDevice : RPM.InputDevice->Devices)
+	const TArray<FSDLDeviceInfo>& InputDevices = RPM.InputDevice->Devices;
+
+	//Units of one model share the GUID. Tell them apart by their order among the connected ones, by SDL device index.
+	TArray<int32> Ordinals;
+	Ordinals.SetNumZeroed(InputDevices.Num());
 	{
-		URequenceDevice* found = nullptr;
-		//Try and match the InputDevice to the Stored Device.
-		for (URequenceDevice* URDevice : Devices)
+		TArray<int32> ByWhich;
+		ByWhich.Reserve(InputDevices.Num());
+		for (int32 i = 0; i < InputDevices.Num(); i++) { ByWhich.Add(i); }
+		ByWhich.Sort([&InputDevices](int32 A, int32 B) { return InputDevices[A].Which < InputDevices[B].Which; });
+
+		TMap<FString, int32> NumUnits;
+		for (int32 i : ByWhich)
 		{
-			//match on name
-			if (RIDevice.Name == URDevice->DeviceString)
-			{
-				found = URDevice;
-			}
-			if (found) break;
+			if (!InputDevices[i].HardwareID.IsEmpty()) { Ordinals[i] = NumUnits.FindOrAdd(InputDevices[i].HardwareID)++; }
+		}
+	}
 
-			//match on action keys
-			for (FRequenceInputAction ac : URDevice->Actions)
-			{
-				if (ac.KeyString.Contains(RIDevice.Name))
-				{
-					found = URDevice;
-					break;
-				}
-			}
-			if (found) break;
+	//Exact matches first, so a unit is never handed a device that belongs to another connected unit.
+	TArray<URequenceDevice*> Matches;
+	Matches.SetNumZeroed(InputDevices.Num());
+	TSet<URequenceDevice*> Claimed;
+	for (int32 i = 0; i < InputDevices.Num(); i++)
+	{
+		URequenceDevice* found = DeviceRegistry.FindByHardwareID(InputDevices[i].HardwareID, Ordinals[i]);
+		if (found && !Claimed.Contains(found))
+		{
+			Matches[i] = found;
+			Claimed.Add(found);
+		}
+	}
+
+	FString KeyName;	//Reused for every key
+	for (int32 i = 0; i < InputDevices.Num(); i++)
+	{
+		const FSDLDeviceInfo& RIDevice = InputDevices[i];
+		URequenceDevice* found = Matches[i];
+
+		//Another unit of the same model, saves from before the ordinal was stored have every unit at 0.
+		if (!found) { found = FindUnclaimedUnique(DeviceRegistry.FindAllByHardwareID(RIDevice.HardwareID), Claimed); }
 
-			//match on axis key.
-			for (FRequenceInputAxis ax : URDevice->Axises)
+		//match on name, saves from before the hardware identity was stored only have that.
+		if (!found) { found = FindUnclaimedUnique(DeviceRegistry.FindAllByString(RIDevice.Name), Claimed); }
+
+		//match on bound keys, which carry the device name.
+		if (!found)
+		{
+			for (URequenceDevice* URDevice : DeviceRegistry.GetDevicesOfType(ERequenceDeviceType::RDT_Unique))
 			{
-				if (ax.KeyString.Contains(RIDevice.Name))
+				if (!Claimed.Contains(URDevice) && HasKeyNamedAfter(*URDevice, RIDevice.Name, KeyName))
 				{
 					found = URDevice;
 					break;
 				}
 			}
-			if (found) break;
-
-			//When all else failed.
-			URDevice->Connected = false;
 		}
 
 		//No device found. Create one!
@@ -344,15 +468,17 @@ void URequence::RequenceInputDevicesUpdated()
 			found->DeviceName = RIDevice.Name;
 			found->RequenceRef = this;
 			found->AddAllEmpty(FullAxisList, FullActionList);
-			found->SortAlphabetically();
-			found->CompactifyAllKeyNames();
 			Devices.Add(found);
+			DeviceRegistry.Add(found);
 		}
+		Claimed.Add(found);
 
-		//Update status.
-		found->DeviceString = RIDevice.Name;
+		//Update status. Replayed and synthetic devices have no hardware identity, keep the stored one.
+		URD_Unique* Unique = Cast<URD_Unique>(found);
+		if (RIDevice.HardwareID.IsEmpty()) { DeviceRegistry.SetIdentity(found, RIDevice.Name, Unique->HardwareID, Unique->HardwareOrdinal); }
+		else { DeviceRegistry.SetIdentity(found, RIDevice.Name, RIDevice.HardwareID, Ordinals[i]); }
 		found->DeviceName = RIDevice.Name;
-		Cast<URD_Unique>(found)->LoadDefaultPhysicalData(RIDevice);
+		Unique->LoadDefaultPhysicalData(RIDevice);
 
 		found->Connected = true;
 	}
@@ -391,7 +517,7 @@ void URequence::ExportDeviceAsPreset(URequenceDevice* Device)
 	}
 }
 
-bool URequence::ImportDeviceAsPreset(FString AbsolutePath)
+bool URequence::ImportDeviceAsPreset(const FString& AbsolutePath)
 {
 	//Load in our file
 	FString InputString;
@@ -418,7 +544,12 @@ bool URequence::ImportDeviceAsPreset(FString AbsolutePath)
 
 				if (StringToEnum<ERequenceDeviceType>("ERequenceDeviceType", sDeviceType) == ERequenceDeviceType::RDT_Unique) {
 					NewDevice = NewObject<URD_Unique>(this, URD_Unique::StaticClass());
-					Cast<URD_Unique>(NewDevice)->bHasPhysicalData = false;	//todo: load physicaldata from JSON
+
+					const TArray<TSharedPtr<FJsonValue>>* JsonPhysicalAxises = nullptr;
+					if (JsonDevice->TryGetArrayField(TEXT("PhysicalAxises"), JsonPhysicalAxises))
+					{
+						Cast<URD_Unique>(NewDevice)->SetJsonAsPhysicalAxises(*JsonPhysicalAxises);
+					}
 				}
 				NewDevice->DeviceType = StringToEnum<ERequenceDeviceType>("ERequenceDeviceType", sDeviceType);
 				NewDevice->DeviceName = JsonDevice->GetStringField(TEXT("DeviceName"));
@@ -427,19 +558,45 @@ bool URequence::ImportDeviceAsPreset(FString AbsolutePath)
 				NewDevice->SetJsonAsAxises(JsonDevice->GetArrayField(TEXT("Axises")));
 
 				NewDevice->RequenceRef = this;
-				NewDevice->AddAllEmpty(FullAxisList, FullActionList);
-				NewDevice->FilterDeleted(FullAxisList, FullActionList);
-				NewDevice->SortAlphabetically();
-				NewDevice->Updated = true;
+				NewDevice->Reconcile(FullAxisList, FullActionList);
+				NewDevice->MarkBindingsChanged();
 
-				//Out with the old, in with the new.
-				if (GetDeviceByType(NewDevice->DeviceType))
+				//Out with the old, in with the new. There is one of every other type, but many unique devices.
+				URequenceDevice* OldDevice = nullptr;
+				if (URD_Unique* NewUnique = Cast<URD_Unique>(NewDevice))
 				{
-					Devices.Remove(GetDeviceByType(NewDevice->DeviceType));
+					//Presets from before the hardware identity was exported only have the name.
+					double HardwareOrdinal = 0.0;
+					JsonDevice->TryGetStringField(TEXT("HardwareID"), NewUnique->HardwareID);
+					JsonDevice->TryGetNumberField(TEXT("HardwareOrdinal"), HardwareOrdinal);
+					NewUnique->HardwareOrdinal = (int32)HardwareOrdinal;
+
+					const TSet<URequenceDevice*> NoneClaimed;
+					OldDevice = DeviceRegistry.FindByHardwareID(NewUnique->HardwareID, NewUnique->HardwareOrdinal);
+					if (!OldDevice) { OldDevice = FindUnclaimedUnique(DeviceRegistry.FindAllByHardwareID(NewUnique->HardwareID), NoneClaimed); }
+					if (!OldDevice) { OldDevice = FindUnclaimedUnique(DeviceRegistry.FindAllByString(NewDevice->DeviceString), NoneClaimed); }
+
+					//Takes over the identity of the unit it replaces, so that unit stays matched to it.
+					if (URD_Unique* OldUnique = Cast<URD_Unique>(OldDevice))
+					{
+						NewUnique->DeviceString = OldUnique->DeviceString;
+						NewUnique->HardwareID = OldUnique->HardwareID;
+						NewUnique->HardwareOrdinal = OldUnique->HardwareOrdinal;
+						NewUnique->Connected = OldUnique->Connected;
+					}
+				}
+				else
+				{
+					OldDevice = DeviceRegistry.FindByType(NewDevice->DeviceType);
 				}
-				Devices.Add(NewDevice);
-
 
+				if (OldDevice)
+				{
+					Devices.RemoveSingle(OldDevice);
+					DeviceRegistry.Remove(OldDevice);
+				}
+				Devices.Add(NewDevice);
+				DeviceRegistry.Add(NewDevice);
 
 				UE_LOG(LogTemp, Log, TEXT("Requence imported %s"), *NewDevice->DeviceName);
 				return true;
@@ -468,56 +625,35 @@ bool URequence::FillFullAxisActionLists()
 	const TArray<FInputActionKeyMapping>& _Actions = Settings->ActionMappings;
 	for (const FInputActionKeyMapping& Each : _Actions)
 	{
-		FName name = Each.ActionName;
-		if (!FullActionList.Contains(name.ToString())) { FullActionList.Add(name.ToString()); }
+		FullActionList.AddUnique(Each.ActionName);
 	}
 
 	const TArray<FInputAxisKeyMapping>& _Axises = Settings->AxisMappings;
 	for (const FInputAxisKeyMapping& Each : _Axises)
 	{
-		FName name = Each.AxisName;
-		if (!FullAxisList.Contains(name.ToString())) { FullAxisList.Add(name.ToString()); }
+		FullAxisList.AddUnique(Each.AxisName);
 	}
 
 	return true;
 }
 
-URequenceDevice* URequence::GetDeviceByString(FString DeviceName)
+URequenceDevice* URequence::GetDeviceByString(const FString& DeviceName)
 {
-	if (Devices.Num() > 0)
-	{
-		for (URequenceDevice* Device : Devices)
-		{
-			if (Device->DeviceString == DeviceName) 
-			{
-				return Device;
-			}
-		}
-	}
-
-	return nullptr;
+	return DeviceRegistry.FindByString(DeviceName);
 }
 
 URequenceDevice* URequence::GetDeviceByType(ERequenceDeviceType DeviceType)
 {
-	if (Devices.Num() > 0)
-	{
-		for (URequenceDevice* Device : Devices)
-		{
-			if (Device->DeviceType == DeviceType)
-			{
-				return Device;
-			}
-		}
-	}
-
-	return nullptr;
+	return DeviceRegistry.FindByType(DeviceType);
 }
 
-URequenceDevice* URequence::CreateDevice(FString KeyName)
+URequenceDevice* URequence::CreateDevice(const FString& KeyName)
 {
-	ERequenceDeviceType NewDeviceType = URequenceDevice::GetDeviceTypeByKeyString(KeyName);
+	return CreateDeviceByType(FRequenceKeyTypes::Get(FKey(*KeyName)));
+}
 
+URequenceDevice* URequence::CreateDeviceByType(ERequenceDeviceType NewDeviceType)
+{
 	if (!IsValid(GetDeviceByType(NewDeviceType)))
 	{
 		URequenceDevice* device = NewObject<URequenceDevice>(this, URequenceDevice::StaticClass());
@@ -531,6 +667,7 @@ URequenceDevice* URequence::CreateDevice(FString KeyName)
 		device->DeviceName = device->DeviceString;
 		device->RequenceRef = this;
 		Devices.Add(device);
+		DeviceRegistry.Add(device);
 		return device;
 	}
 
@@ -539,17 +676,8 @@ URequenceDevice* URequence::CreateDevice(FString KeyName)
 
 TArray<URequenceDevice*> URequence::GetUniqueDevices()
 {
-	TArray<URequenceDevice*> toReturn;
-
-	for (URequenceDevice* device : Devices)
-	{
-		if (device->DeviceType == ERequenceDeviceType::RDT_Unique)
-		{
-			toReturn.Add(device);
-		}
-	}
-
-	return toReturn;
+	TArrayView<URequenceDevice* const> UniqueDevices = GetUniqueDevicesView();
+	return TArray<URequenceDevice*>(UniqueDevices.GetData(), UniqueDevices.Num());
 }
 
 void URequence::DebugPrint(bool UseDevices = true)
@@ -568,16 +696,16 @@ void URequence::DebugPrint(bool UseDevices = true)
 
 				if (Device->Axises.Num() > 0)
 				{
-					for (FRequenceInputAxis ax : Device->Axises)
+					for (const FRequenceInputAxis& ax : Device->Axises)
 					{
-						UE_LOG(LogTemp, Log, TEXT("  * Axis %s (%s : %f)"), *ax.AxisName, *ax.Key.ToString(), ax.Scale);
+						UE_LOG(LogTemp, Log, TEXT("  * Axis %s (%s : %f)"), *ax.AxisName.ToString(), *ax.Key.ToString(), ax.Scale);
 					}
 				}
 				if (Device->Actions.Num() > 0)
 				{
-					for (FRequenceInputAction ac : Device->Actions)
+					for (const FRequenceInputAction& ac : Device->Actions)
 					{
-						UE_LOG(LogTemp, Log, TEXT("  * Action %s (%s)"), *ac.ActionName, *ac.Key.ToString());
+						UE_LOG(LogTemp, Log, TEXT("  * Action %s (%s)"), *ac.ActionName.ToString(), *ac.Key.ToString());
 					}
 				}
 			}
@@ -592,18 +720,18 @@ void URequence::DebugPrint(bool UseDevices = true)
 		if (Axises.Num() > 0)
 		{
 			UE_LOG(LogTemp, Log, TEXT("- Axises found: %i"), Axises.Num());
-			for (FRequenceInputAxis ax : Axises)
+			for (const FRequenceInputAxis& ax : Axises)
 			{
-				UE_LOG(LogTemp, Log, TEXT("  * Axis %s (%s)"), *ax.AxisName, *ax.Key.ToString());
+				UE_LOG(LogTemp, Log, TEXT("  * Axis %s (%s)"), *ax.AxisName.ToString(), *ax.Key.ToString());
 			}
 		}
 		else { UE_LOG(LogTemp, Log, TEXT("- No Axises found!")); }
 		if (Actions.Num() > 0)
 		{
 			UE_LOG(LogTemp, Log, TEXT("- Actions found: %i"), Actions.Num());
-			for (FRequenceInputAction ac : Actions)
+			for (const FRequenceInputAction& ac : Actions)
 			{
-				UE_LOG(LogTemp, Log, TEXT("  * Action %s (%s)"), *ac.ActionName, *ac.Key.ToString());
+				UE_LOG(LogTemp, Log, TEXT("  * Action %s (%s)"), *ac.ActionName.ToString(), *ac.Key.ToString());
 			}
 		}
 		else { UE_LOG(LogTemp, Log, TEXT("- No Actions found!")); }
@@ -612,6 +740,8 @@ void URequence::DebugPrint(bool UseDevices = true)
 
 void URequence::ClearDevicesAndAxises()
 {
+	KeyIndex.Reset();
+	DeviceRegistry.Reset();
 	Actions.Empty();
 	Axises.Empty();
 	Devices.Empty();
@@ -654,3 +784,108 @@ void URequence::SetEditModeEnded()
 	EditModeDeviceType = ERequenceDeviceType::RDT_Unknown;
 	OnEditModeEnded.Broadcast();
 }
+
+TArray<FRequenceDeviceLatency> URequence::GetInputLatency()
+{
+	TArray<FRequenceDeviceLatency> Latency;
+	FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
+	if (RPM.InputDevice.IsValid())
+	{
+		RPM.InputDevice->GetLatency(Latency);
+	}
+	return Latency;
+}
+
+void URequence::ReportInputConsumed(const FKey& Key)
+{
+	FRequencePluginModule& RPM = FModuleManager::LoadModuleChecked<FRequencePluginModule>("RequencePlugin");
+	if (RPM.InputDevice.IsValid())
+	{
+		RPM.InputDevice->ReportInputConsumed(Key);
+	}
+}
+
+TArrayView<const FRequenceKeyBinding> URequence::FindBindingsByKey(const FRequenceKeyChord& Chord)
+{
+	KeyIndex.Update(Devices);
+	return KeyIndex.Find(Chord);
+}
+
+bool URequence::HasBindingConflict(const FKey& Key, bool bShift, bool bCtrl, bool bAlt, bool bCmd, FName IgnoreName)
+{
+	for (const FRequenceKeyBinding& Binding : FindBindingsByKey(FRequenceKeyChord(Key, bShift, bCtrl, bAlt, bCmd)))
+	{
+		if (Binding.Name != IgnoreName) { return true; }
+	}
+	return false;
+}
+
+bool URequence::GetBindingConflicts(const FKey& Key, bool bShift, bool bCtrl, bool bAlt, bool bCmd, TArray<FRequenceBindingConflict>& OutConflicts)
+{
+	OutConflicts.Reset();
+	for (const FRequenceKeyBinding& Binding : FindBindingsByKey(FRequenceKeyChord(Key, bShift, bCtrl, bAlt, bCmd)))
+	{
+		FRequenceBindingConflict Conflict;
+		Conflict.Device = Binding.Device.Get();
+		Conflict.Name = Binding.Name;
+		Conflict.bIsAxis = Binding.bIsAxis;
+		OutConflicts.Add(Conflict);
+	}
+	return OutConflicts.Num() > 0;
+}
+
+const FRequenceBindingTable& URequence::GetBindingTable()
+{
+	if (!BindingTable.IsUpToDate(Devices))
+	{
+		BindingTable.Compile(Devices);
+	}
+	return BindingTable;
+}
+
+bool URequence::GetBoundKeys(URequenceDevice* Device, FName Name, bool bIsAxis, TArray<FKey>& OutKeys)
+{
+	OutKeys.Reset();
+
+	const FRequenceBindingTable& Table = GetBindingTable();
+	for (const FRequenceCompiledBinding& Binding : Table.Find(Table.FindDeviceID(Device), Table.FindNameID(Name), bIsAxis))
+	{
+		OutKeys.Add(Table.GetKey(Binding.KeyID));
+	}
+	return OutKeys.Num() > 0;
+}
+
+FKey URequence::GetFirstBoundKey(URequenceDevice* Device, FName Name, bool bIsAxis)
+{
+	const FRequenceBindingTable& Table = GetBindingTable();
+	TArrayView<const FRequenceCompiledBinding> Bindings = Table.Find(Table.FindDeviceID(Device), Table.FindNameID(Name), bIsAxis);
+	return Bindings.Num() > 0 ? Table.GetKey(Bindings[0].KeyID) : FKey();
+}
+
+const FRequenceEngineMappings& URequence::GetEngineMappings()
+{
+	bool bUpToDate = EngineMappingSources.Num() == Devices.Num();
+	for (int32 i = 0; bUpToDate && i < Devices.Num(); i++)
+	{
+		bUpToDate = EngineMappingSources[i].Get() == &Devices[i]->GetEngineMappings().Get();
+	}
+	if (bUpToDate) { return EngineMappings; }
+
+	EngineMappingSources.Reset(Devices.Num());
+	int32 NumActions = 0, NumAxises = 0;
+	for (URequenceDevice* d : Devices)
+	{
+		EngineMappingSources.Add(d->GetEngineMappings());
+		NumActions += EngineMappingSources.Last()->Actions.Num();
+		NumAxises += EngineMappingSources.Last()->Axises.Num();
+	}
+
+	EngineMappings.Actions.Reset(NumActions);
+	EngineMappings.Axises.Reset(NumAxises);
+	for (const TSharedRef<const FRequenceEngineMappings>& DeviceMappings : EngineMappingSources)
+	{
+		EngineMappings.Actions.Append(DeviceMappings->Actions);
+		EngineMappings.Axises.Append(DeviceMappings->Axises);
+	}
+	return EngineMappings;
+}
@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceBenchmark.h"
+#include "RequenceInputDevice.h"
+#include "RequenceInputSources.h"
+#include "RequenceInputRecording.h"
+#include "RequenceDevice.h"
+#include "PlatformTime.h"
+#include "PlatformTLS.h"
+#include "GenericApplicationMessageHandler.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Allocation counting
+//////////////////////////////////////////////////////////////////////////
+
+//Forwards everything to the real allocator, counting allocations of one thread.
+class FRequenceCountingMalloc : public FMalloc
+{
+public:
+	FMalloc* Inner = nullptr;
+	uint32 CountedThreadId = 0;
+	int64 Count = 0;
+
+	virtual void* Malloc(SIZE_T Size, uint32 Alignment) override
+	{
+		CountAllocation();
+		return Inner->Malloc(Size, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Size, uint32 Alignment) override
+	{
+		if (Size > 0) { CountAllocation(); }
+		return Inner->Realloc(Original, Size, Alignment);
+	}
+
+	virtual void Free(void* Original) override { Inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Size, uint32 Alignment) override { return Inner->QuantizeSize(Size, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+	virtual void Trim() override { Inner->Trim(); }
+	virtual const TCHAR* GetDescriptiveName() override { return TEXT("RequenceCountingMalloc"); }
+
+private:
+	void CountAllocation()
+	{
+		if (FPlatformTLS::GetCurrentThreadId() == CountedThreadId) { Count++; }
+	}
+};
+
+//Never destroyed, other threads may still hold on to it after a counter went out of scope.
+static FRequenceCountingMalloc GRequenceCountingMalloc;
+
+FRequenceScopedAllocationCounter::FRequenceScopedAllocationCounter()
+{
+	check(GMalloc != &GRequenceCountingMalloc);
+
+	GRequenceCountingMalloc.Inner = GMalloc;
+	GRequenceCountingMalloc.CountedThreadId = FPlatformTLS::GetCurrentThreadId();
+	GRequenceCountingMalloc.Count = 0;
+	GMalloc = &GRequenceCountingMalloc;
+}
+
+FRequenceScopedAllocationCounter::~FRequenceScopedAllocationCounter()
+{
+	GMalloc = GRequenceCountingMalloc.Inner;
+}
+
+int64 FRequenceScopedAllocationCounter::GetCount() const
+{
+	return GRequenceCountingMalloc.Count;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Input benchmark
+//////////////////////////////////////////////////////////////////////////
+
+static FRequenceBenchmarkResult RunInputCase(const TCHAR* Name, RequenceInputDevice& Device, const FRequenceSyntheticInputConfig& Config,
+	int32 NumEvents, TFunctionRef<void(const FRequenceInputEvent&)> Handler)
+{
+	FRequenceSyntheticInputSource Generator(Config);
+	TArray<FRequenceInputEvent> Events;
+	Generator.GenerateEvents(NumEvents, Events);
+
+	//Warm up caches and any lazily built state.
+	for (int32 i = 0; i < Events.Num() && i < 1000; i++)
+	{
+		Handler(Events[i]);
+	}
+	Device.FlushCoalescedAxises();
+
+	FRequenceBenchmarkResult Result;
+	Result.Name = Name;
+	Result.NumEvents = Events.Num();
+	{
+		FRequenceScopedAllocationCounter Allocations;
+		double StartTime = FPlatformTime::Seconds();
+
+		for (const FRequenceInputEvent& Event : Events)
+		{
+			Handler(Event);
+		}
+		Device.FlushCoalescedAxises();
+
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		Result.NumAllocations = Allocations.GetCount();
+	}
+	return Result;
+}
+
+TArray<FRequenceBenchmarkResult> FRequenceBenchmark::RunInputBenchmark(int32 NumEvents)
+{
+	//Devices only, nothing is generated while pumping.
+	FRequenceSyntheticInputConfig DeviceConfig;
+	DeviceConfig.NumDevices = 4;
+	DeviceConfig.AxisRate = 0.f;
+	DeviceConfig.ButtonRate = 0.f;
+	DeviceConfig.HatRate = 0.f;
+
+	RequenceInputDevice Device(MakeShareable(new FGenericApplicationMessageHandler()),
+		MakeShareable(new FRequenceSyntheticInputSource(DeviceConfig)), false, true);
+	Device.SendControllerEvents();
+
+	FRequenceSyntheticInputConfig AxisConfig = DeviceConfig;
+	AxisConfig.AxisRate = 1000.f;
+	FRequenceSyntheticInputConfig ButtonConfig = DeviceConfig;
+	ButtonConfig.ButtonRate = 10.f;
+	FRequenceSyntheticInputConfig HatConfig = DeviceConfig;
+	HatConfig.HatRate = 10.f;
+
+	TArray<FRequenceBenchmarkResult> Results;
+
+	Device.bCoalesceAxisEvents = false;
+	Results.Add(RunInputCase(TEXT("HandleInput_Axis"), Device, AxisConfig, NumEvents,
+		[&Device](const FRequenceInputEvent& Event) { Device.HandleInput_Axis(Event); }));
+
+	//Roughly one frame worth of a 4 device setup between flushes.
+	Device.bCoalesceAxisEvents = true;
+	int32 EventsSinceFlush = 0;
+	Results.Add(RunInputCase(TEXT("HandleInput_Axis (coalesced)"), Device, AxisConfig, NumEvents,
+		[&Device, &EventsSinceFlush](const FRequenceInputEvent& Event)
+		{
+			Device.HandleInput_Axis(Event);
+			if (++EventsSinceFlush >= 256)
+			{
+				Device.FlushCoalescedAxises();
+				EventsSinceFlush = 0;
+			}
+		}));
+
+	Results.Add(RunInputCase(TEXT("HandleInput_Button"), Device, ButtonConfig, NumEvents,
+		[&Device](const FRequenceInputEvent& Event) { Device.HandleInput_Button(Event); }));
+
+	Results.Add(RunInputCase(TEXT("HandleInput_Hat"), Device, HatConfig, NumEvents,
+		[&Device](const FRequenceInputEvent& Event) { Device.HandleInput_Hat(Event); }));
+
+	return Results;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Binding benchmark
+//////////////////////////////////////////////////////////////////////////
+
+//Order of the results of RunBindingBenchmark.
+enum ERequenceBindingCase
+{
+	RBC_Load,
+	RBC_Apply,
+	RBC_Save
+};
+
+//A saved device with NumBindings actions and axises, every other one bound.
+static FRequenceSaveObjectDevice MakeSyntheticDevice(int32 DeviceIndex, int32 NumBindings, const TArray<FKey>& Keys)
+{
+	FRequenceSaveObjectDevice Device;
+	Device.DeviceString = FString::Printf(TEXT("Synthetic%i"), DeviceIndex);
+	Device.DeviceName = Device.DeviceString;
+	Device.DeviceType = ERequenceDeviceType::RDT_Keyboard;
+	for (int32 i = 0; i < NumBindings; i++)
+	{
+		const FKey Key = i % 2 == 0 ? Keys[(DeviceIndex + i) % Keys.Num()] : FKey();
+		Device.Actions.Add(FRequenceInputAction(FName(TEXT("Action"), i), Key, false, false, false, false));
+		Device.Axises.Add(FRequenceInputAxis(FName(TEXT("Axis"), i), Key, 1.f));
+	}
+	return Device;
+}
+
+TArray<FRequenceBenchmarkResult> FRequenceBenchmark::RunBindingBenchmark(int32 NumDevices, int32 NumBindings)
+{
+	TArray<FKey> Keys;
+	EKeys::GetAllKeys(Keys);
+
+	TArray<FName> ActionNames, AxisNames;
+	for (int32 i = 0; i < NumBindings; i++)
+	{
+		ActionNames.Add(FName(TEXT("Action"), i));
+		AxisNames.Add(FName(TEXT("Axis"), i));
+	}
+
+	TArray<FRequenceSaveObjectDevice> SavedDevices;
+	for (int32 i = 0; i < NumDevices; i++)
+	{
+		SavedDevices.Add(MakeSyntheticDevice(i, NumBindings, Keys));
+	}
+
+	TArray<URequenceDevice*> Devices;
+	Devices.Reserve(NumDevices);
+	TArray<FRequenceSaveObjectDevice> Saved;
+	Saved.Reserve(NumDevices);
+
+	TArray<FRequenceBenchmarkResult> Results;
+	Results.SetNum(RBC_Save + 1);
+	const FString Suffix = FString::Printf(TEXT(" (%ix%i)"), NumDevices, NumBindings * 2);
+	Results[RBC_Load].Name = TEXT("Bindings load") + Suffix;
+	Results[RBC_Apply].Name = TEXT("Bindings apply") + Suffix;
+	Results[RBC_Save].Name = TEXT("Bindings save") + Suffix;
+	for (FRequenceBenchmarkResult& Result : Results)
+	{
+		Result.NumEvents = NumDevices * NumBindings * 2;
+	}
+
+	//Same steps as URequence::LoadInput, ApplyAxisesAndActions and SaveInput, without touching the save slot or Input.ini.
+	{
+		FRequenceScopedAllocationCounter Allocations;
+		double StartTime = FPlatformTime::Seconds();
+		for (FRequenceSaveObjectDevice& SavedDevice : SavedDevices)
+		{
+			URequenceDevice* Device = NewObject<URequenceDevice>(GetTransientPackage());
+			Device->FromStruct(MoveTemp(SavedDevice), nullptr, AxisNames, ActionNames);
+			Devices.Add(Device);
+		}
+		Results[RBC_Load].Seconds = FPlatformTime::Seconds() - StartTime;
+		Results[RBC_Load].NumAllocations = Allocations.GetCount();
+	}
+	{
+		FRequenceScopedAllocationCounter Allocations;
+		double StartTime = FPlatformTime::Seconds();
+		for (URequenceDevice* Device : Devices)
+		{
+			Device->GetEngineMappings();
+		}
+		Results[RBC_Apply].Seconds = FPlatformTime::Seconds() - StartTime;
+		Results[RBC_Apply].NumAllocations = Allocations.GetCount();
+	}
+	{
+		FRequenceScopedAllocationCounter Allocations;
+		double StartTime = FPlatformTime::Seconds();
+		for (URequenceDevice* Device : Devices)
+		{
+			Saved.Add(Device->ToStruct());
+		}
+		Results[RBC_Save].Seconds = FPlatformTime::Seconds() - StartTime;
+		Results[RBC_Save].NumAllocations = Allocations.GetCount();
+	}
+
+	for (URequenceDevice* Device : Devices)
+	{
+		Device->MarkPendingKill();
+	}
+	return Results;
+}
+
+bool FRequenceBenchmark::CheckBindingAllocations(int32 NumDevices, int32 NumBindings, TArray<FRequenceBenchmarkResult>& OutResults, FOutputDevice& Ar)
+{
+	TArray<FRequenceBenchmarkResult> Small = RunBindingBenchmark(NumDevices, NumBindings);
+	TArray<FRequenceBenchmarkResult> Large = RunBindingBenchmark(NumDevices, NumBindings * 2);
+
+	bool bPassed = true;
+	const ERequenceBindingCase CheckedCases[] = { RBC_Load, RBC_Apply, RBC_Save };
+	for (ERequenceBindingCase Case : CheckedCases)
+	{
+		if (Large[Case].NumAllocations > Small[Case].NumAllocations)
+		{
+			Ar.Logf(ELogVerbosity::Error, TEXT("%s: %lld allocations, %lld with half the bindings. Should not depend on the number of bindings."),
+				*Large[Case].Name, Large[Case].NumAllocations, Small[Case].NumAllocations);
+			bPassed = false;
+		}
+	}
+
+	OutResults.Append(Small);
+	OutResults.Append(Large);
+	return bPassed;
+}
+
+FRequenceBenchmarkResult FRequenceBenchmark::RunReplayBenchmark(const FString& Filename)
+{
+	FRequenceBenchmarkResult Result;
+	Result.Name = FPaths::GetBaseFilename(Filename);
+
+	FRequenceInputPlayer Player;
+	if (!Player.Load(Filename)) { return Result; }
+
+	//No devices of its own, the recording brings them.
+	FRequenceSyntheticInputConfig Config;
+	Config.NumDevices = 0;
+	RequenceInputDevice Device(MakeShareable(new FGenericApplicationMessageHandler()),
+		MakeShareable(new FRequenceSyntheticInputSource(Config)), false, true);
+
+	FRequenceScopedAllocationCounter Allocations;
+	double StartTime = FPlatformTime::Seconds();
+
+	Result.NumEvents = Player.Replay(Device);
+
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+	Result.NumAllocations = Allocations.GetCount();
+	return Result;
+}
+
+void FRequenceBenchmark::PrintResults(const TArray<FRequenceBenchmarkResult>& Results, FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("%-32s %10s %14s %10s %12s"), TEXT("Case"), TEXT("Events"), TEXT("Events/s"), TEXT("ns/event"), TEXT("Allocations"));
+	for (const FRequenceBenchmarkResult& Result : Results)
+	{
+		Ar.Logf(TEXT("%-32s %10lld %14.0f %10.1f %12lld"), *Result.Name, Result.NumEvents,
+			Result.GetEventsPerSecond(), Result.GetNanosecondsPerEvent(), Result.NumAllocations);
+	}
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceBenchmarkCommandlet.h"
+#include "RequenceBenchmark.h"
+
+URequenceBenchmarkCommandlet::URequenceBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 URequenceBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumEvents = FRequenceBenchmark::DefaultNumEvents;
+	FParse::Value(*Params, TEXT("Events="), NumEvents);
+	int32 NumDevices = FRequenceBenchmark::DefaultNumDevices;
+	FParse::Value(*Params, TEXT("Devices="), NumDevices);
+	int32 NumBindings = FRequenceBenchmark::DefaultNumBindings;
+	FParse::Value(*Params, TEXT("Bindings="), NumBindings);
+
+	if (NumEvents <= 0 || NumDevices <= 0 || NumBindings <= 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("RequenceBenchmark: -Events, -Devices and -Bindings must be positive"));
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("RequenceBenchmark: %i events per case"), NumEvents);
+	TArray<FRequenceBenchmarkResult> Results = FRequenceBenchmark::RunInputBenchmark(NumEvents);
+
+	//Captured sessions, see -RequenceRecord.
+	FString ReplayFile;
+	if (FParse::Value(*Params, TEXT("Replay="), ReplayFile))
+	{
+		Results.Add(FRequenceBenchmark::RunReplayBenchmark(ReplayFile));
+	}
+
+	const bool bAllocationsPassed = FRequenceBenchmark::CheckBindingAllocations(NumDevices, NumBindings, Results, *GLog);
+
+	FRequenceBenchmark::PrintResults(Results, *GLog);
+	return bAllocationsPassed ? 0 : 1;
+}
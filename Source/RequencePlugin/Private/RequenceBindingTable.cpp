@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceBindingTable.h"
+#include "RequenceDevice.h"
+
+bool FRequenceBindingTable::IsUpToDate(const TArray<URequenceDevice*>& InDevices) const
+{
+	if (Generation == 0 || Devices.Num() != InDevices.Num()) { return false; }
+
+	for (int32 DeviceID = 0; DeviceID < Devices.Num(); DeviceID++)
+	{
+		if (Devices[DeviceID].Get() != InDevices[DeviceID]) { return false; }
+		if (DeviceGenerations[DeviceID] != InDevices[DeviceID]->GetBindingsGeneration()) { return false; }
+	}
+	return true;
+}
+
+void FRequenceBindingTable::Compile(const TArray<URequenceDevice*>& InDevices)
+{
+	Bindings.Reset();
+	Devices.Reset(InDevices.Num());
+	DeviceGenerations.Reset(InDevices.Num());
+	DeviceIDs.Reset();
+
+	//Rebuilt every time, names and keys that are no longer bound would otherwise keep widening the cells.
+	Names.Reset();
+	NameIDs.Reset();
+	Keys.Reset();
+	KeyIDs.Reset();
+
+	for (int32 DeviceID = 0; DeviceID < InDevices.Num(); DeviceID++)
+	{
+		const URequenceDevice* Device = InDevices[DeviceID];
+		Devices.Add(InDevices[DeviceID]);
+		DeviceGenerations.Add(Device->GetBindingsGeneration());
+		DeviceIDs.Add(Device, DeviceID);
+
+		for (const FRequenceInputAction& ac : Device->Actions)
+		{
+			if (!IsBindingBound(ac.Key)) { continue; }
+
+			FRequenceCompiledBinding Binding;
+			Binding.NameID = AddName(ac.ActionName);
+			Binding.KeyID = AddKey(ac.Key);
+			Binding.DeviceID = DeviceID;
+			Binding.Modifiers = FRequenceKeyChord(ac).Modifiers;
+			Binding.bIsAxis = 0;
+			Binding.Scale = 1.f;
+			Bindings.Add(Binding);
+		}
+
+		for (const FRequenceInputAxis& ax : Device->Axises)
+		{
+			if (!IsBindingBound(ax.Key)) { continue; }
+
+			FRequenceCompiledBinding Binding;
+			Binding.NameID = AddName(ax.AxisName);
+			Binding.KeyID = AddKey(ax.Key);
+			Binding.DeviceID = DeviceID;
+			Binding.Modifiers = 0;
+			Binding.bIsAxis = 1;
+			Binding.Scale = ax.Scale;
+			Bindings.Add(Binding);
+		}
+	}
+
+	//Cells depend on the number of names, which is only known now.
+	Bindings.StableSort([this](const FRequenceCompiledBinding& A, const FRequenceCompiledBinding& B)
+	{
+		return GetCell(A.DeviceID, A.NameID, A.bIsAxis != 0) < GetCell(B.DeviceID, B.NameID, B.bIsAxis != 0);
+	});
+
+	const int32 NumCells = Devices.Num() * Names.Num() * 2;
+	CellStarts.SetNumUninitialized(NumCells + 1);
+	int32 Next = 0;
+	for (int32 Cell = 0; Cell <= NumCells; Cell++)
+	{
+		while (Next < Bindings.Num() && GetCell(Bindings[Next].DeviceID, Bindings[Next].NameID, Bindings[Next].bIsAxis != 0) < Cell)
+		{
+			Next++;
+		}
+		CellStarts[Cell] = Next;
+	}
+
+	Generation++;
+}
+
+int32 FRequenceBindingTable::FindNameID(FName Name) const
+{
+	const int32* NameID = NameIDs.Find(Name);
+	return NameID ? *NameID : INDEX_NONE;
+}
+
+int32 FRequenceBindingTable::FindKeyID(const FKey& Key) const
+{
+	const int32* KeyID = KeyIDs.Find(Key);
+	return KeyID ? *KeyID : INDEX_NONE;
+}
+
+int32 FRequenceBindingTable::FindDeviceID(const URequenceDevice* Device) const
+{
+	const int32* DeviceID = DeviceIDs.Find(Device);
+	return DeviceID ? *DeviceID : INDEX_NONE;
+}
+
+TArrayView<const FRequenceCompiledBinding> FRequenceBindingTable::Find(int32 DeviceID, int32 NameID, bool bIsAxis) const
+{
+	if (!Devices.IsValidIndex(DeviceID) || !Names.IsValidIndex(NameID)) { return TArrayView<const FRequenceCompiledBinding>(); }
+
+	const int32 Cell = GetCell(DeviceID, NameID, bIsAxis);
+	return TArrayView<const FRequenceCompiledBinding>(Bindings.GetData() + CellStarts[Cell], CellStarts[Cell + 1] - CellStarts[Cell]);
+}
+
+int32 FRequenceBindingTable::AddName(FName Name)
+{
+	if (const int32* NameID = NameIDs.Find(Name)) { return *NameID; }
+	return NameIDs.Add(Name, Names.Add(Name));
+}
+
+int32 FRequenceBindingTable::AddKey(const FKey& Key)
+{
+	if (const int32* KeyID = KeyIDs.Find(Key)) { return *KeyID; }
+	return KeyIDs.Add(Key, Keys.Add(Key));
+}
@@ -1,13 +1,19 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "RequenceDevice.h"
+#include "Requence.h"
+#include "RequenceKeyTypes.h"
 #include "JsonObject.h"
 
+uint32 URequenceDevice::AllBindingsGeneration = 0;
+
 URequenceDevice::URequenceDevice()
 {
+	//A new device can take the place of a collected one, caches must not take it for the old one.
+	AllBindingsGeneration++;
 }
 
-ERequenceDeviceType URequenceDevice::GetDeviceTypeByKeyString(FString KeyString)
+ERequenceDeviceType URequenceDevice::GetDeviceTypeByKeyString(const FString& KeyString)
 {
 	if (KeyString.Contains("Mouse")) { return ERequenceDeviceType::RDT_Mouse; }
 	if (KeyString.Contains("Gamepad")) { return ERequenceDeviceType::RDT_Gamepad; }
@@ -20,9 +26,9 @@ ERequenceDeviceType URequenceDevice::GetDeviceTypeByKeyString(FString KeyString)
 	return ERequenceDeviceType::RDT_Unknown;
 }
 
-ERequenceDeviceType URequenceDevice::GetDeviceTypeByKey(FKey Key)
+ERequenceDeviceType URequenceDevice::GetDeviceTypeByKey(const FKey& Key)
 {
-	return GetDeviceTypeByKeyString(Key.GetDisplayName().ToString());
+	return FRequenceKeyTypes::Get(Key);
 }
 
 FString URequenceDevice::GetDeviceNameByType(ERequenceDeviceType DeviceType)
@@ -53,164 +59,305 @@ FString URequenceDevice::GetDeviceNameByType(ERequenceDeviceType DeviceType)
 	}
 }
 
-void URequenceDevice::CompactifyAllKeyNames()
+FString URequenceDevice::GenerateKeyString(const FKey& key, bool bDoCompactify)
 {
-	for (FRequenceInputAction& ac : Actions)
-	{
-		ac.KeyString = CompactifyKeyString(ac.KeyString);
-	}
-	for (FRequenceInputAxis& ax : Axises)
-	{
-		ax.KeyString = CompactifyKeyString(ax.KeyString);
-	}
+	if (!IsBindingBound(key)) { return FString(); }
+	if (bDoCompactify) { return GetCompactKeyString(key); }
+	return key.GetDisplayName().ToString();
 }
 
-FRequenceInputAction URequenceDevice::UpdateKeyStringAction(FRequenceInputAction Action, bool bDoCompactify)
+FString URequenceDevice::GetActionKeyString(const FRequenceInputAction& Action, bool bDoCompactify)
 {
-	FRequenceInputAction toReturn = Action;
-	if (Action.Key != FKey()) { toReturn.KeyString = GenerateKeyString(toReturn.Key, bDoCompactify); }
-	return toReturn;
+	return GenerateKeyString(Action.Key, bDoCompactify);
 }
 
-FRequenceInputAxis URequenceDevice::UpdateKeyStringAxis(FRequenceInputAxis Axis, bool bDoCompactify)
+FString URequenceDevice::GetAxisKeyString(const FRequenceInputAxis& Axis, bool bDoCompactify)
 {
-	FRequenceInputAxis toReturn = Axis;
-	if (Axis.Key != FKey()) { toReturn.KeyString = GenerateKeyString(toReturn.Key, bDoCompactify); }
-	return toReturn;
+	return GenerateKeyString(Axis.Key, bDoCompactify);
 }
 
-FString URequenceDevice::GenerateKeyString(FKey key, bool bDoCompactify)
+void URequenceDevice::CompactifyAllKeyNames()
 {
-	FString toReturn;
-	toReturn.Append(key.GetDisplayName().ToString());
-	if (bDoCompactify) { toReturn = CompactifyKeyString(toReturn); }
-	return toReturn;
 }
 
-FString URequenceDevice::CompactifyKeyString(FString InName)
-{
-	FString outName = InName;
-	if (outName == "Mouse X" || outName == "Mouse Y") { outName.Append(" Axis"); }
-	outName = outName.Replace(TEXT("Gamepad "), TEXT(""));
-	outName = outName.Replace(TEXT("MotionController "), TEXT(""));
-	outName = outName.Replace(TEXT("Mouse "), TEXT(""));
-	outName = outName.Replace(TEXT("Joystick"), TEXT(""));
-	outName = outName.Replace(TEXT("Requence"), TEXT(""));
-	outName = outName.Replace(TEXT("stick"), TEXT("stk"));
-	outName = outName.Replace(TEXT("button"), TEXT("btn"));
-	outName = outName.Replace(TEXT("Shift"), TEXT("shft"));
-	outName = outName.Replace(TEXT("Control"), TEXT("ctrl"));
-	outName = outName.Replace(TEXT("Command"), TEXT("cmd"));
-	outName = outName.Replace(TEXT("_"), TEXT(" "));
-	outName.TrimStartInline();
-	return outName;
+FRequenceInputAction URequenceDevice::UpdateKeyStringAction(const FRequenceInputAction& Action, bool bDoCompactify)
+{
+	return Action;
+}
+
+FRequenceInputAxis URequenceDevice::UpdateKeyStringAxis(const FRequenceInputAxis& Axis, bool bDoCompactify)
+{
+	return Axis;
 }
 
-bool URequenceDevice::HasActionBinding(FString ActionName, bool MustBeBound)
+//One rewrite of CompactifyKeyString, matched without case.
+struct FRequenceCompactRule
 {
-	for (FRequenceInputAction ac : Actions)
+	const TCHAR* From;
+	int32 FromLen;
+	const TCHAR* To;
+};
+
+#define REQUENCE_COMPACT_RULE(From, To) { TEXT(From), ARRAY_COUNT(From) - 1, TEXT(To) }
+
+//When several rules match at the same position, the first one wins.
+static const FRequenceCompactRule GRequenceCompactRules[] =
+{
+	REQUENCE_COMPACT_RULE("Gamepad ", ""),
+	REQUENCE_COMPACT_RULE("MotionController ", ""),
+	REQUENCE_COMPACT_RULE("Mouse ", ""),
+	REQUENCE_COMPACT_RULE("Joystick", ""),
+	REQUENCE_COMPACT_RULE("Requence", ""),
+	REQUENCE_COMPACT_RULE("stick", "stk"),
+	REQUENCE_COMPACT_RULE("button", "btn"),
+	REQUENCE_COMPACT_RULE("Shift", "shft"),
+	REQUENCE_COMPACT_RULE("Control", "ctrl"),
+	REQUENCE_COMPACT_RULE("Command", "cmd"),
+	REQUENCE_COMPACT_RULE("_", " ")
+};
+
+#undef REQUENCE_COMPACT_RULE
+
+//Single pass over the name, into one buffer.
+static FString CompactKeyName(const FString& InName)
+{
+	const TCHAR* Name = *InName;
+	const int32 Len = InName.Len();
+
+	FString outName;
+	outName.Reserve(Len + 5);
+	for (int32 i = 0; i < Len;)
 	{
-		if (ac.ActionName == ActionName) 
-		{ 
-			if (MustBeBound)
+		const FRequenceCompactRule* Match = nullptr;
+		for (const FRequenceCompactRule& Rule : GRequenceCompactRules)
+		{
+			if (Rule.FromLen <= Len - i && FChar::ToLower(Name[i]) == FChar::ToLower(Rule.From[0])
+				&& FCString::Strnicmp(Name + i, Rule.From, Rule.FromLen) == 0)
 			{
-				if (ac.Key != FKey()) { return true; }
+				Match = &Rule;
+				break;
 			}
-			else { return true; }
+		}
+
+		if (Match)
+		{
+			outName += Match->To;
+			i += Match->FromLen;
+		}
+		else
+		{
+			outName.AppendChar(Name[i]);
+			i++;
 		}
 	}
-	return false;
-}
 
-bool URequenceDevice::HasAxisBinding(FString AxisName, bool MustBeBound)
-{
-	for (FRequenceInputAxis ax : Axises)
+	//Mouse X and Y would otherwise end up as just X and Y.
+	if (InName.Equals(TEXT("Mouse X"), ESearchCase::IgnoreCase) || InName.Equals(TEXT("Mouse Y"), ESearchCase::IgnoreCase))
 	{
-		if (ax.AxisName == AxisName) 
-		{ 
-			if (MustBeBound) {
-				if (ax.Key != FKey()) { return true; }
-			}
-			else { return true; }
-		}
+		outName += TEXT(" Axis");
 	}
-	return false;
+
+	outName.TrimStartInline();
+	return outName;
+}
+
+FString URequenceDevice::CompactifyKeyString(const FString& InName)
+{
+	return CompactKeyName(InName);
+}
+
+const FString& URequenceDevice::GetCompactKeyString(const FKey& Key)
+{
+	//Game thread only, like the rest of the bindings. Display names are read on first use and not refreshed.
+	//The strings live on the heap, so references stay valid when the map grows.
+	static TMap<FKey, TSharedRef<const FString>> CompactKeyStrings;
+
+	if (const TSharedRef<const FString>* Found = CompactKeyStrings.Find(Key)) { return **Found; }
+
+	return *CompactKeyStrings.Add(Key, MakeShared<const FString>(CompactKeyName(Key.GetDisplayName().ToString())));
 }
 
-int URequenceDevice::HasNumOfActionBinding(FString ActionName, bool bMustBeBound)
+bool URequenceDevice::HasActionBinding(FName ActionName, bool MustBeBound)
 {
-	int toReturn = 0;
-	for (FRequenceInputAction ac : Actions)
+	return HasNumOfActionBinding(ActionName, MustBeBound) > 0;
+}
+
+bool URequenceDevice::HasAxisBinding(FName AxisName, bool MustBeBound)
+{
+	return HasNumOfAxisBinding(AxisName, MustBeBound) > 0;
+}
+
+int URequenceDevice::HasNumOfActionBinding(FName ActionName, bool bMustBeBound)
+{
+	ActionIndex.Update(Actions);
+	const FRequenceBindingSlots* Slots = ActionIndex.FindSlots(ActionName);
+	if (Slots == nullptr) { return 0; }
+	return bMustBeBound ? Slots->NumBound : Slots->Slots.Num();
+}
+
+int URequenceDevice::HasNumOfAxisBinding(FName AxisName, bool bMustBeBound)
+{
+	AxisIndex.Update(Axises);
+	const FRequenceBindingSlots* Slots = AxisIndex.FindSlots(AxisName);
+	if (Slots == nullptr) { return 0; }
+	return bMustBeBound ? Slots->NumBound : Slots->Slots.Num();
+}
+
+//Stable sort on name. Names are only compared alphabetically while ranking the distinct ones, the sort itself compares integers.
+//The order is shown to players, so the ranks stay alphabetical instead of following FName indices.
+template<typename BindingType>
+static void SortBindingsByName(TArray<BindingType>& Bindings)
+{
+	//Saved and reconciled bindings come in sorted, check that before allocating anything.
+	//Equal FNames compare by index, only the boundaries between names need a string compare.
+	bool bIsSorted = true;
+	for (int32 i = 1; i < Bindings.Num() && bIsSorted; i++)
+	{
+		const FName Name = GetBindingName(Bindings[i]);
+		const FName Previous = GetBindingName(Bindings[i - 1]);
+		bIsSorted = Name == Previous || !(Name < Previous);
+	}
+	if (bIsSorted) { return; }
+
+	TMap<FName, int32> Ranks;
+	TArray<FName> Names;
+	Ranks.Reserve(Bindings.Num());
+	Names.Reserve(Bindings.Num());
+	for (const BindingType& Binding : Bindings)
 	{
-		if (ac.ActionName == ActionName)
+		if (!Ranks.Contains(GetBindingName(Binding)))
 		{
-			if (bMustBeBound)
-			{
-				if (ac.Key != FKey()) { toReturn++; }
-			}
-			else { toReturn++; }
+			Ranks.Add(GetBindingName(Binding), 0);
+			Names.Add(GetBindingName(Binding));
 		}
 	}
-	return toReturn;
+	Names.Sort();
+	for (int32 i = 0; i < Names.Num(); i++)
+	{
+		Ranks[Names[i]] = i;
+	}
+
+	//X: rank, Y: current slot, so equal names keep their order.
+	TArray<FIntPoint> Order;
+	Order.Reserve(Bindings.Num());
+	for (int32 i = 0; i < Bindings.Num(); i++)
+	{
+		Order.Add(FIntPoint(Ranks[GetBindingName(Bindings[i])], i));
+	}
+
+	Order.Sort([](const FIntPoint& A, const FIntPoint& B) { return A.X != B.X ? A.X < B.X : A.Y < B.Y; });
+
+	TArray<BindingType> Sorted;
+	Sorted.Reserve(Bindings.Num());
+	for (const FIntPoint& Entry : Order)
+	{
+		Sorted.Add(MoveTemp(Bindings[Entry.Y]));
+	}
+	Bindings = MoveTemp(Sorted);
 }
 
-int URequenceDevice::HasNumOfAxisBinding(FString AxisName, bool bMustBeBound)
+//Slot after the last binding named Name, where a new binding with that name goes. Index must be up to date.
+//Known names are answered by the index, only a name the device does not have yet is searched alphabetically.
+template<typename BindingType>
+static int32 UpperBoundByName(const TArray<BindingType>& Bindings, const TRequenceBindingIndex<BindingType>& Index, const FName Name)
 {
-	int toReturn = 0;
-	for (FRequenceInputAxis ax : Axises)
+	if (const FRequenceBindingSlots* Slots = Index.FindSlots(Name))
 	{
-		if (ax.AxisName == AxisName)
-		{
-			if (bMustBeBound) {
-				if (ax.Key != FKey()) { toReturn++; }
-			}
-			else { toReturn++; }
-		}
+		if (Slots->Slots.Num() > 0) { return Slots->Slots.Last() + 1; }
 	}
-	return toReturn;
+
+	int32 Low = 0;
+	int32 High = Bindings.Num();
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		if (Name < GetBindingName(Bindings[Mid])) { High = Mid; }
+		else { Low = Mid + 1; }
+	}
+	return Low;
 }
 
-void URequenceDevice::SortAlphabetically()
+//Removes bindings whose name is not in FullList and adds empty ones until every name has NumRequired, in one pass.
+//Either step is skipped when bRemoveDeleted is false or NumRequired is 0. Returns the number of removed bindings.
+template<typename BindingType>
+static int32 ReconcileBindings(TArray<BindingType>& Bindings, const TArray<FName>& FullList, int32 NumRequired, bool bRemoveDeleted,
+	TArray<FName>* OutAdded, TArray<FName>* OutRemoved)
 {
-	//Actions
-	bool acswapped = true;
-	int acJ = 0;
-	while (acswapped)
+	//Bindings found per name in the full list.
+	TMap<FName, int32> Counts;
+	Counts.Reserve(FullList.Num());
+	for (const FName Name : FullList)
 	{
-		acswapped = false;
-		acJ++;
+		Counts.Add(Name, 0);
+	}
 
-		for (int i = 0; i < (Actions.Num() - acJ); i++)
+	//Compact in place, which keeps the order and so keeps them sorted.
+	int32 NumKept = 0;
+	for (int32 i = 0; i < Bindings.Num(); i++)
+	{
+		int32* Count = Counts.Find(GetBindingName(Bindings[i]));
+		if (Count == nullptr && bRemoveDeleted)
 		{
-			if (Actions[i].ActionName > Actions[i + 1].ActionName)
-			{
-				FRequenceInputAction cache = Actions[i];
-				Actions[i] = Actions[i + 1];
-				Actions[i + 1] = cache;
-				acswapped = true;
-			}
+			if (OutRemoved) { OutRemoved->Add(GetBindingName(Bindings[i])); }
+			continue;
 		}
+
+		if (Count) { (*Count)++; }
+		if (NumKept != i) { Bindings[NumKept] = MoveTemp(Bindings[i]); }
+		NumKept++;
 	}
+	const int32 NumRemoved = Bindings.Num() - NumKept;
+	Bindings.SetNum(NumKept, false);
 
-	//Axises
-	bool axswapped = true;
-	int axJ = 0;
-	while (axswapped)
+	for (const FName Name : FullList)
 	{
-		axswapped = false;
-		axJ++;
-
-		for (int i = 0; i < (Axises.Num() - axJ); i++)
+		int32& Count = Counts[Name];
+		for (; Count < NumRequired; Count++)
 		{
-			if (Axises[i].AxisName > Axises[i + 1].AxisName)
-			{
-				FRequenceInputAxis cache = Axises[i];
-				Axises[i] = Axises[i + 1];
-				Axises[i + 1] = cache;
-				axswapped = true;
-			}
+			Bindings.Add(BindingType(Name));
+			if (OutAdded) { OutAdded->Add(Name); }
 		}
 	}
+
+	//Append everything, then sort once.
+	if (Bindings.Num() != NumKept) { SortBindingsByName(Bindings); }
+	return NumRemoved;
+}
+
+bool URequenceDevice::Reconcile(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList, int numRequired, bool bRemoveDeleted, FRequenceReconcileResult* OutResult)
+{
+	const int32 NumActions = Actions.Num();
+	const int32 NumAxises = Axises.Num();
+
+	const int32 NumRemoved = ReconcileBindings(Actions, FullActionList, numRequired, bRemoveDeleted,
+		OutResult ? &OutResult->AddedActions : nullptr, OutResult ? &OutResult->RemovedActions : nullptr)
+		+ ReconcileBindings(Axises, FullAxisList, numRequired, bRemoveDeleted,
+		OutResult ? &OutResult->AddedAxises : nullptr, OutResult ? &OutResult->RemovedAxises : nullptr);
+
+	//Removing or adding anything moves slots around.
+	const bool bChanged = NumRemoved > 0 || Actions.Num() != NumActions || Axises.Num() != NumAxises;
+	if (bChanged) { MarkBindingIndexDirty(); }
+
+	//Added bindings are empty, only removals change what is bound.
+	if (NumRemoved > 0) { MarkBindingsChanged(); }
+	return bChanged;
+}
+
+void URequenceDevice::AddAllEmpty(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList, int numRequired)
+{
+	Reconcile(FullAxisList, FullActionList, numRequired, false);
+}
+
+bool URequenceDevice::FilterDeleted(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList)
+{
+	return Reconcile(FullAxisList, FullActionList, 0, true);
+}
+
+void URequenceDevice::SortAlphabetically()
+{
+	SortBindingsByName(Actions);
+	SortBindingsByName(Axises);
+	MarkBindingIndexDirty();
 }
 
 bool URequenceDevice::StartEditMode()
@@ -222,248 +369,243 @@ bool URequenceDevice::StartEditMode()
 	return false;
 }
 
-void URequenceDevice::AddAllEmpty(TArray<FString> FullAxisList, TArray<FString> FullActionList, int numRequired)
+TSharedRef<const FRequenceEngineMappings> URequenceDevice::GetEngineMappings() const
 {
-	for (FString ac : FullActionList)
+	if (EngineMappings.IsValid() && EngineMappingsGeneration == BindingsGeneration) { return EngineMappings.ToSharedRef(); }
+
+	TSharedRef<FRequenceEngineMappings> Mappings = MakeShareable(new FRequenceEngineMappings());
+	Mappings->Actions.Reserve(Actions.Num());
+	Mappings->Axises.Reserve(Axises.Num());
+	for (const FRequenceInputAction& ac : Actions)
 	{
-		for (int i = HasNumOfActionBinding(ac, false); i < numRequired; i++) {
-			FRequenceInputAction newAction;
-			newAction.ActionName = ac;
-			Actions.Add(newAction);
-		}
+		if (!IsBindingBound(ac.Key)) { continue; }
+
+		FInputActionKeyMapping NewAction;
+		NewAction.ActionName = ac.ActionName;
+		NewAction.Key = ac.Key;
+		NewAction.bShift = ac.bShift;
+		NewAction.bCtrl = ac.bCtrl;
+		NewAction.bAlt = ac.bAlt;
+		NewAction.bCmd = ac.bCmd;
+		Mappings->Actions.Add(NewAction);
 	}
-	for (FString ax : FullAxisList)
+
+	for (const FRequenceInputAxis& ax : Axises)
 	{
-		for (int i = HasNumOfAxisBinding(ax, false); i < numRequired; i++) {
-			FRequenceInputAxis newAxis;
-			newAxis.AxisName = ax;
-			Axises.Add(newAxis);
-		}
+		if (!IsBindingBound(ax.Key)) { continue; }
+
+		FInputAxisKeyMapping NewAxis;
+		NewAxis.AxisName = ax.AxisName;
+		NewAxis.Key = ax.Key;
+		NewAxis.Scale = ax.Scale;
+		Mappings->Axises.Add(NewAxis);
 	}
+
+	EngineMappings = Mappings;
+	EngineMappingsGeneration = BindingsGeneration;
+	return Mappings;
 }
 
-bool URequenceDevice::FilterDeleted(TArray<FString> FullAxisList, TArray<FString> FullActionList)
+void URequenceDevice::MarkBindingMoved(bool bIsAxis, FName OldName, const FRequenceKeyChord& OldChord, FName NewName, const FRequenceKeyChord& NewChord)
 {
-	int deleted = 0;
-	if (Actions.Num() > 0)
-	{
-		for (int i = Actions.Num() - 1; i >= 0; i--)
-		{
-			if (!FullActionList.Contains(Actions[i].ActionName))
-			{
-				Actions.RemoveAt(i);
-				deleted++;
-			}
-		}
-	}
+	const uint32 OldGeneration = BindingsGeneration;
+	MarkBindingsChanged();
 
-	if (Axises.Num() > 0)
+	if (IsValid(RequenceRef))
 	{
-		for (int i = Axises.Num() - 1; i >= 0; i--)
-		{
-			if (!FullAxisList.Contains(Axises[i].AxisName))
-			{
-				Axises.RemoveAt(i);
-				deleted++;
-			}
-		}
+		RequenceRef->GetKeyIndex().OnBindingMoved(this, OldGeneration, BindingsGeneration, bIsAxis, OldName, OldChord, NewName, NewChord);
 	}
+}
 
-	if (deleted > 0) 
-	{
-		Updated = true;
-		return true;
-	}
-	return false;
+void URequenceDevice::MarkBindingIndexDirty()
+{
+	ActionIndex.MarkDirty();
+	AxisIndex.MarkDirty();
 }
 
-bool URequenceDevice::AddAction(FRequenceInputAction _action)
+bool URequenceDevice::AddAction(const FRequenceInputAction& _action)
 {
 	//Check for duplicates.
-	for (FRequenceInputAction action : Actions)
-	{
-		if (_action.Key == action.Key && _action.ActionName == action.ActionName)
-		{
-			return false;
-		}
-	}
+	ActionIndex.Update(Actions);
+	if (ActionIndex.FindSlot(Actions, _action.ActionName, _action.Key) != INDEX_NONE) { return false; }
 
-	Actions.Add(_action);
-	Updated = true;
+	const int32 Slot = UpperBoundByName(Actions, ActionIndex, _action.ActionName);
+	Actions.Insert(_action, Slot);
+	ActionIndex.OnInserted(Actions, Slot);
+	MarkBindingMoved(false, NAME_None, FRequenceKeyChord(), _action.ActionName, FRequenceKeyChord(_action));
 	return true;
 }
 
-bool URequenceDevice::AddAxis(FRequenceInputAxis _axis)
+bool URequenceDevice::AddAxis(const FRequenceInputAxis& _axis)
 {
 	//Check for duplicates.
-	for (FRequenceInputAxis axis : Axises)
-	{
-		if (_axis.Key == axis.Key && _axis.AxisName == axis.AxisName) {
-			return false;
-		}
-	}
+	AxisIndex.Update(Axises);
+	if (AxisIndex.FindSlot(Axises, _axis.AxisName, _axis.Key) != INDEX_NONE) { return false; }
 
-	Axises.Add(_axis);
-	Updated = true;
+	const int32 Slot = UpperBoundByName(Axises, AxisIndex, _axis.AxisName);
+	Axises.Insert(_axis, Slot);
+	AxisIndex.OnInserted(Axises, Slot);
+	MarkBindingMoved(true, NAME_None, FRequenceKeyChord(), _axis.AxisName, FRequenceKeyChord(_axis));
 	return true;
 }
 
-bool URequenceDevice::RebindAction(FRequenceInputAction OldAction, FRequenceInputAction UpdatedAction)
+bool URequenceDevice::RebindAction(const FRequenceInputAction& OldAction, const FRequenceInputAction& UpdatedAction)
 {
-	if (DeviceType == GetDeviceTypeByKeyString(UpdatedAction.Key.ToString()))
+	const ERequenceDeviceType KeyType = FRequenceKeyTypes::Get(UpdatedAction.Key);
+	if (DeviceType == KeyType)
 	{
-		int toChange = -1;
-		for (int i = 0; i < Actions.Num(); i++)
+		ActionIndex.Update(Actions);
+		int toChange = ActionIndex.FindSlot(Actions, OldAction.ActionName, OldAction.Key);
+		if (toChange >= 0)
 		{
-			if (Actions[i].ActionName == OldAction.ActionName && Actions[i].Key == OldAction.Key)
+			//Either argument may alias the slot, read them before overwriting it.
+			const FName OldName = Actions[toChange].ActionName;
+			const FRequenceKeyChord OldChord(Actions[toChange]);
+			const bool bSameName = UpdatedAction.ActionName == OldName;
+
+			if (bSameName)
 			{
-				toChange = i;
-				break;
+				Actions[toChange] = UpdatedAction;
+				ActionIndex.OnKeyChanged(Actions, toChange, OldChord.Key);
+			}
+			else
+			{
+				//Renamed, move it to where the new name sorts. AddAction and AddAxis rely on the order.
+				//The bound is taken while the index still matches the array, then corrected for the removed slot.
+				FRequenceInputAction Renamed = UpdatedAction;
+				int32 Slot = UpperBoundByName(Actions, ActionIndex, Renamed.ActionName);
+				if (Slot > toChange) { Slot--; }
+				Actions.RemoveAt(toChange, 1, false);
+				Actions.Insert(MoveTemp(Renamed), Slot);
+				toChange = Slot;
+				ActionIndex.MarkDirty();
 			}
-		}
 
-		//Outside of for loop since we shouldn't modify a loop while iterating over it. Even though it *should* be safe.
-		if (toChange >= 0)
-		{
-			Actions.RemoveAt(toChange, 1, false);
-			FRequenceInputAction a = UpdatedAction;
-			a.KeyString = CompactifyKeyString(a.Key.ToString());
-			Actions.Insert(a, toChange);
-			Updated = true;
+			MarkBindingMoved(false, OldName, OldChord, Actions[toChange].ActionName, FRequenceKeyChord(Actions[toChange]));
 			return true;
 		}
 	}
 	else
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Requence did not bind a %s key to a %s device!"),
-			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", GetDeviceTypeByKeyString(UpdatedAction.Key.ToString())),
+			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", KeyType),
 			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", DeviceType)
 		);
 	}
 	return false;
 }
 
-bool URequenceDevice::RebindAxis(FRequenceInputAxis OldAxis, FRequenceInputAxis UpdatedAxis)
+bool URequenceDevice::RebindAxis(const FRequenceInputAxis& OldAxis, const FRequenceInputAxis& UpdatedAxis)
 {
-	if (DeviceType == GetDeviceTypeByKeyString(UpdatedAxis.Key.ToString()))
+	const ERequenceDeviceType KeyType = FRequenceKeyTypes::Get(UpdatedAxis.Key);
+	if (DeviceType == KeyType)
 	{
-		int toChange = -1;
-		for (int i = 0; i < Axises.Num(); i++)
+		AxisIndex.Update(Axises);
+		int toChange = AxisIndex.FindSlot(Axises, OldAxis.AxisName, OldAxis.Key);
+		if (toChange >= 0)
 		{
-			if (Axises[i].AxisName == OldAxis.AxisName && Axises[i].Key == OldAxis.Key)
+			//Either argument may alias the slot, read them before overwriting it.
+			const FName OldName = Axises[toChange].AxisName;
+			const FRequenceKeyChord OldChord(Axises[toChange]);
+			const bool bSameName = UpdatedAxis.AxisName == OldName;
+
+			if (bSameName)
 			{
-				toChange = i;
-				break;
+				Axises[toChange] = UpdatedAxis;
+				AxisIndex.OnKeyChanged(Axises, toChange, OldChord.Key);
+			}
+			else
+			{
+				//Renamed, move it to where the new name sorts. AddAction and AddAxis rely on the order.
+				//The bound is taken while the index still matches the array, then corrected for the removed slot.
+				FRequenceInputAxis Renamed = UpdatedAxis;
+				int32 Slot = UpperBoundByName(Axises, AxisIndex, Renamed.AxisName);
+				if (Slot > toChange) { Slot--; }
+				Axises.RemoveAt(toChange, 1, false);
+				Axises.Insert(MoveTemp(Renamed), Slot);
+				toChange = Slot;
+				AxisIndex.MarkDirty();
 			}
-		}
 
-		//Outside of for loop since we shouldn't modify a loop while iterating over it. Even though it *should* be safe.
-		if (toChange >= 0)
-		{
-			Axises.RemoveAt(toChange, 1, false);
-			FRequenceInputAxis a = UpdatedAxis;
-			a.KeyString = CompactifyKeyString(a.Key.ToString());
-			Axises.Insert(a, toChange);
-			Updated = true;
+			MarkBindingMoved(true, OldName, OldChord, Axises[toChange].AxisName, FRequenceKeyChord(Axises[toChange]));
 			return true;
 		}
 	}
 	else
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Requence did not bind a %s key to a %s device!"),
-			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", GetDeviceTypeByKeyString(UpdatedAxis.Key.ToString())),
+			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", KeyType),
 			*EnumToString<ERequenceDeviceType>("ERequenceDeviceType", DeviceType)
 		);
 	}
 	return false;
 }
 
-bool URequenceDevice::DeleteActionKeys(FString ActionName)
+bool URequenceDevice::DeleteActionKeys(FName ActionName)
 {
-	int deleted = 0;
-	if (Actions.Num() > 0) 
+	ActionIndex.Update(Actions);
+	const FRequenceBindingSlots* Slots = ActionIndex.FindSlots(ActionName);
+	if (Slots == nullptr) { return false; }
+
+	for (int32 Slot : Slots->Slots)
 	{
-		for (int i = 0; i < Actions.Num(); i++)
-		{
-			if (Actions[i].ActionName == ActionName)
-			{
-				FString temp = Actions[i].ActionName;
-				Actions[i] = FRequenceInputAction(temp);
-				deleted++;
-				Updated = true;
-			}
-		}
+		const FRequenceKeyChord OldChord(Actions[Slot]);
+		Actions[Slot] = FRequenceInputAction(Actions[Slot].ActionName);
+		ActionIndex.OnKeyChanged(Actions, Slot, OldChord.Key);
+		MarkBindingMoved(false, ActionName, OldChord, ActionName, FRequenceKeyChord());
 	}
-	if (deleted > 0) { return true; }
-	return false;
+	return true;
 }
 
-bool URequenceDevice::DeleteAxisKeys(FString AxisName)
+bool URequenceDevice::DeleteAxisKeys(FName AxisName)
 {
-	int deleted = 0;
-	if (Axises.Num() > 0)
+	AxisIndex.Update(Axises);
+	const FRequenceBindingSlots* Slots = AxisIndex.FindSlots(AxisName);
+	if (Slots == nullptr) { return false; }
+
+	for (int32 Slot : Slots->Slots)
 	{
-		for (int i = 0; i < Axises.Num(); i++)
-		{
-			if (Axises[i].AxisName == AxisName)
-			{
-				FString temp = Axises[i].AxisName;
-				Axises[i] = FRequenceInputAxis(temp);
-				deleted++;
-				Updated = true;
-			}
-		}
+		const FRequenceKeyChord OldChord(Axises[Slot]);
+		Axises[Slot] = FRequenceInputAxis(Axises[Slot].AxisName);
+		AxisIndex.OnKeyChanged(Axises, Slot, OldChord.Key);
+		MarkBindingMoved(true, AxisName, OldChord, AxisName, FRequenceKeyChord());
 	}
-	if (deleted > 0) { return true; }
-	return false;
+	return true;
 }
 
-void URequenceDevice::FromStruct(FRequenceSaveObjectDevice StructIn, URequence* _RequenceRef, 
-	TArray<FString> FullAxisList, TArray<FString> FullActionList)
+void URequenceDevice::FromStruct(FRequenceSaveObjectDevice&& StructIn, URequence* _RequenceRef, 
+	const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList)
 {
-	DeviceString = StructIn.DeviceString;
-	DeviceName = StructIn.DeviceName;
+	DeviceString = MoveTemp(StructIn.DeviceString);
+	DeviceName = MoveTemp(StructIn.DeviceName);
 	DeviceType = StructIn.DeviceType;
-	Actions = StructIn.Actions;
-	Axises = StructIn.Axises;
+	Actions = MoveTemp(StructIn.Actions);
+	Axises = MoveTemp(StructIn.Axises);
 	RequenceRef = _RequenceRef;
-
-	AddAllEmpty(FullAxisList, FullActionList);
-	FilterDeleted(FullAxisList, FullActionList);
 	SortAlphabetically();
+	BumpBindingsGeneration();
+
+	Reconcile(FullAxisList, FullActionList);
 }
 
-FRequenceSaveObjectDevice URequenceDevice::ToStruct()
+FRequenceSaveObjectDevice URequenceDevice::ToStruct() const
 {
 	FRequenceSaveObjectDevice toReturn;
 	toReturn.DeviceString = DeviceString;
 	toReturn.DeviceName = DeviceName;
 	toReturn.DeviceType = DeviceType;
-	toReturn.Actions = Actions;
-	toReturn.Axises = Axises;
 
-	//Filter empty keys
-	if (toReturn.Actions.Num() > 0)
+	//Only bound keys are saved, which is exactly what the engine mappings hold.
+	TSharedRef<const FRequenceEngineMappings> Mappings = GetEngineMappings();
+	toReturn.Actions.Reserve(Mappings->Actions.Num());
+	for (const FInputActionKeyMapping& ac : Mappings->Actions)
 	{
-		for (int i = toReturn.Actions.Num() - 1; i >= 0; i--)
-		{
-			if (toReturn.Actions[i].Key == FKey())
-			{
-				toReturn.Actions.RemoveAt(i);
-			}
-		}
+		toReturn.Actions.Add(FRequenceInputAction(ac));
 	}
-
-	//Filter empty keys
-	if (toReturn.Axises.Num() > 0)
+	toReturn.Axises.Reserve(Mappings->Axises.Num());
+	for (const FInputAxisKeyMapping& ax : Mappings->Axises)
 	{
-		for (int i = toReturn.Axises.Num() - 1; i >= 0; i--)
-		{
-			if (toReturn.Axises[i].Key == FKey())
-			{
-				toReturn.Axises.RemoveAt(i);
-			}
-		}
+		toReturn.Axises.Add(FRequenceInputAxis(ax));
 	}
 
 	return toReturn;
@@ -491,12 +633,12 @@ TSharedPtr<FJsonObject> URequenceDevice::GetDeviceAsJson()
 TArray<TSharedPtr<FJsonValue>> URequenceDevice::GetActionsAsJson()
 {
 	TArray<TSharedPtr<FJsonValue>> JsonActions;
-	for (FRequenceInputAction ac : Actions)
+	TSharedRef<const FRequenceEngineMappings> Mappings = GetEngineMappings();
+	JsonActions.Reserve(Mappings->Actions.Num());
+	for (const FInputActionKeyMapping& ac : Mappings->Actions)
 	{
-		if (ac.Key == FKey()) { continue; }	//Skip if empty.
-
 		TSharedPtr<FJsonObject> Action = MakeShareable(new FJsonObject);
-		Action->SetStringField("ActionName", ac.ActionName);
+		Action->SetStringField("ActionName", ac.ActionName.ToString());
 		Action->SetStringField("Key", ac.Key.ToString());
 		Action->SetBoolField("bShift", ac.bShift);
 		Action->SetBoolField("bCtrl", ac.bCtrl);
@@ -512,12 +654,12 @@ TArray<TSharedPtr<FJsonValue>> URequenceDevice::GetActionsAsJson()
 TArray<TSharedPtr<FJsonValue>> URequenceDevice::GetAxisesAsJson()
 {
 	TArray<TSharedPtr<FJsonValue>> JsonAxises;
-	for (FRequenceInputAxis ax : Axises)
+	TSharedRef<const FRequenceEngineMappings> Mappings = GetEngineMappings();
+	JsonAxises.Reserve(Mappings->Axises.Num());
+	for (const FInputAxisKeyMapping& ax : Mappings->Axises)
 	{
-		if (ax.Key == FKey()) { continue; }	//Skip if empty.
-
 		TSharedPtr<FJsonObject> Axis = MakeShareable(new FJsonObject);
-		Axis->SetStringField("AxisName", ax.AxisName);
+		Axis->SetStringField("AxisName", ax.AxisName.ToString());
 		Axis->SetStringField("Key", ax.Key.ToString());
 		Axis->SetNumberField("Scale", (double)ax.Scale);
 
@@ -527,18 +669,18 @@ TArray<TSharedPtr<FJsonValue>> URequenceDevice::GetAxisesAsJson()
 	return JsonAxises;
 }
 
-void URequenceDevice::SetJsonAsActions(TArray<TSharedPtr<FJsonValue>> _Actions)
+void URequenceDevice::SetJsonAsActions(const TArray<TSharedPtr<FJsonValue>>& _Actions)
 {
+	Actions.Reserve(Actions.Num() + _Actions.Num());
 	for (int i = 0; i < _Actions.Num(); i++)
 	{
-		TSharedPtr<FJsonObject> JsonAction = _Actions[i]->AsObject();
+		const TSharedPtr<FJsonObject>& JsonAction = _Actions[i]->AsObject();
 
 		if (JsonAction->GetStringField(TEXT("Key")) != "None")
 		{
 			FRequenceInputAction NewAction;
-			NewAction.ActionName = JsonAction->GetStringField(TEXT("ActionName"));
+			NewAction.ActionName = FName(*JsonAction->GetStringField(TEXT("ActionName")));
 			NewAction.Key = FKey(FName(*JsonAction->GetStringField(TEXT("Key"))));
-			NewAction.KeyString = CompactifyKeyString(NewAction.Key.ToString());
 			NewAction.bShift = JsonAction->GetBoolField(TEXT("bShift"));
 			NewAction.bCtrl = JsonAction->GetBoolField(TEXT("bCtrl"));
 			NewAction.bAlt = JsonAction->GetBoolField(TEXT("bAlt"));
@@ -546,22 +688,28 @@ void URequenceDevice::SetJsonAsActions(TArray<TSharedPtr<FJsonValue>> _Actions)
 			Actions.Add(NewAction);
 		}
 	}
+	SortBindingsByName(Actions);
+	ActionIndex.MarkDirty();
+	BumpBindingsGeneration();
 }
 
-void URequenceDevice::SetJsonAsAxises(TArray<TSharedPtr<FJsonValue>> _Axises)
+void URequenceDevice::SetJsonAsAxises(const TArray<TSharedPtr<FJsonValue>>& _Axises)
 {
+	Axises.Reserve(Axises.Num() + _Axises.Num());
 	for (int i = 0; i < _Axises.Num(); i++)
 	{
-		TSharedPtr<FJsonObject> JsonAxis = _Axises[i]->AsObject();
+		const TSharedPtr<FJsonObject>& JsonAxis = _Axises[i]->AsObject();
 
 		if (JsonAxis->GetStringField(TEXT("Key")) != "None")
 		{
 			FRequenceInputAxis NewAxis;
-			NewAxis.AxisName = JsonAxis->GetStringField(TEXT("AxisName"));
+			NewAxis.AxisName = FName(*JsonAxis->GetStringField(TEXT("AxisName")));
 			NewAxis.Key = FKey(FName(*JsonAxis->GetStringField(TEXT("Key"))));
-			NewAxis.KeyString = CompactifyKeyString(NewAxis.Key.ToString());
 			NewAxis.Scale = JsonAxis->GetNumberField(TEXT("Scale"));
 			Axises.Add(NewAxis);
 		}
 	}
+	SortBindingsByName(Axises);
+	AxisIndex.MarkDirty();
+	BumpBindingsGeneration();
 }
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceDeviceRegistry.h"
+#include "RequenceDevice.h"
+#include "RD_Unique.h"
+
+void FRequenceDeviceRegistry::Add(URequenceDevice* Device)
+{
+	ByType[(int32)Device->DeviceType].Add(Device);
+	AddTo(ByString, Device->DeviceString, Device);
+	AddTo(ByHardwareID, GetHardwareID(Device), Device);
+}
+
+void FRequenceDeviceRegistry::Remove(URequenceDevice* Device)
+{
+	ByType[(int32)Device->DeviceType].Remove(Device);
+	RemoveFrom(ByString, Device->DeviceString, Device);
+	RemoveFrom(ByHardwareID, GetHardwareID(Device), Device);
+}
+
+void FRequenceDeviceRegistry::Reset()
+{
+	for (TArray<URequenceDevice*>& Devices : ByType)
+	{
+		Devices.Reset();
+	}
+	ByString.Reset();
+	ByHardwareID.Reset();
+}
+
+void FRequenceDeviceRegistry::SetIdentity(URequenceDevice* Device, const FString& DeviceString, const FString& HardwareID, int32 HardwareOrdinal)
+{
+	RemoveFrom(ByString, Device->DeviceString, Device);
+	RemoveFrom(ByHardwareID, GetHardwareID(Device), Device);
+
+	Device->DeviceString = DeviceString;
+	if (URD_Unique* Unique = Cast<URD_Unique>(Device))
+	{
+		Unique->HardwareID = HardwareID;
+		Unique->HardwareOrdinal = HardwareOrdinal;
+	}
+
+	AddTo(ByString, Device->DeviceString, Device);
+	AddTo(ByHardwareID, GetHardwareID(Device), Device);
+}
+
+URequenceDevice* FRequenceDeviceRegistry::FindByType(ERequenceDeviceType DeviceType) const
+{
+	const TArray<URequenceDevice*>& Devices = ByType[(int32)DeviceType];
+	return Devices.Num() > 0 ? Devices[0] : nullptr;
+}
+
+URequenceDevice* FRequenceDeviceRegistry::FindByString(const FString& DeviceString) const
+{
+	return FindIn(ByString, DeviceString);
+}
+
+URequenceDevice* FRequenceDeviceRegistry::FindByHardwareID(const FString& HardwareID, int32 HardwareOrdinal) const
+{
+	//Only as many entries as units of one model.
+	for (URequenceDevice* Device : FindAllByHardwareID(HardwareID))
+	{
+		if (Cast<URD_Unique>(Device)->HardwareOrdinal == HardwareOrdinal) { return Device; }
+	}
+	return nullptr;
+}
+
+TArrayView<URequenceDevice* const> FRequenceDeviceRegistry::FindAllByString(const FString& DeviceString) const
+{
+	return FindAllIn(ByString, DeviceString);
+}
+
+TArrayView<URequenceDevice* const> FRequenceDeviceRegistry::FindAllByHardwareID(const FString& HardwareID) const
+{
+	return FindAllIn(ByHardwareID, HardwareID);
+}
+
+TArrayView<URequenceDevice* const> FRequenceDeviceRegistry::GetDevicesOfType(ERequenceDeviceType DeviceType) const
+{
+	return TArrayView<URequenceDevice* const>(ByType[(int32)DeviceType]);
+}
+
+const FString& FRequenceDeviceRegistry::GetHardwareID(const URequenceDevice* Device)
+{
+	static const FString NoHardwareID;
+	const URD_Unique* Unique = Cast<URD_Unique>(Device);
+	return Unique ? Unique->HardwareID : NoHardwareID;
+}
+
+void FRequenceDeviceRegistry::AddTo(TMap<FString, FDeviceList>& Map, const FString& Key, URequenceDevice* Device)
+{
+	if (Key.IsEmpty()) { return; }
+	Map.FindOrAdd(Key).Add(Device);
+}
+
+void FRequenceDeviceRegistry::RemoveFrom(TMap<FString, FDeviceList>& Map, const FString& Key, URequenceDevice* Device)
+{
+	FDeviceList* Devices = Map.Find(Key);
+	if (Devices == nullptr) { return; }
+
+	//Keep the order, the first one added is the one found.
+	Devices->Remove(Device);
+	if (Devices->Num() == 0) { Map.Remove(Key); }
+}
+
+URequenceDevice* FRequenceDeviceRegistry::FindIn(const TMap<FString, FDeviceList>& Map, const FString& Key)
+{
+	const FDeviceList* Devices = Map.Find(Key);
+	return Devices ? (*Devices)[0] : nullptr;
+}
+
+TArrayView<URequenceDevice* const> FRequenceDeviceRegistry::FindAllIn(const TMap<FString, FDeviceList>& Map, const FString& Key)
+{
+	const FDeviceList* Devices = Map.Find(Key);
+	if (Devices == nullptr) { return TArrayView<URequenceDevice* const>(); }
+	return TArrayView<URequenceDevice* const>(Devices->GetData(), Devices->Num());
+}
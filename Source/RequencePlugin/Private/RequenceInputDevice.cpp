@@ -7,131 +7,156 @@
 #include "RequenceSaveObject.h"
 #include "Requence.h"
 #include "RequenceStructs.h"
+#include "RequenceStats.h"
+#include "RequenceBenchmark.h"
+#include "RequenceKeyTypes.h"
 
 #define LOCTEXT_NAMESPACE "RequencePlugin"
 
-RequenceInputDevice::RequenceInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) : MessageHandler(InMessageHandler)
+const FRequenceHatDirection RequenceInputDevice::HatDirectionTable[16] =
 {
-	InitSDL();
-}
+	{ INDEX_NONE,	 0,	 0 },	//SDL_HAT_CENTERED
+	{ 4,			 0,	 1 },	//SDL_HAT_UP
+	{ 6,			 1,	 0 },	//SDL_HAT_RIGHT
+	{ 5,			 1,	 1 },	//SDL_HAT_RIGHTUP
+	{ 0,			 0,	-1 },	//SDL_HAT_DOWN
+	{ INDEX_NONE,	 0,	 0 },	//Up + Down
+	{ 7,			 1,	-1 },	//SDL_HAT_RIGHTDOWN
+	{ INDEX_NONE,	 0,	 0 },	//Up + Right + Down
+	{ 2,			-1,	 0 },	//SDL_HAT_LEFT
+	{ 3,			-1,	 1 },	//SDL_HAT_LEFTUP
+	{ INDEX_NONE,	 0,	 0 },	//Left + Right
+	{ INDEX_NONE,	 0,	 0 },	//Left + Up + Right
+	{ 1,			-1,	-1 },	//SDL_HAT_LEFTDOWN
+	{ INDEX_NONE,	 0,	 0 },	//Left + Up + Down
+	{ INDEX_NONE,	 0,	 0 },	//Left + Right + Down
+	{ INDEX_NONE,	 0,	 0 }	//All
+};
 
-RequenceInputDevice::~RequenceInputDevice()
+RequenceInputDevice::RequenceInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) : MessageHandler(InMessageHandler)
 {
-	UE_LOG(LogTemp, Log, TEXT("Quitting SDL."));
-
-	SDL_DelEventWatch(HandleSDLEvent, this);
-
-	for (FSDLDeviceInfo Device : Devices) {
-		if (Device.Joystick != nullptr) {
-			SDL_JoystickClose(Device.Joystick);
-		}
+	//Headless runs without hardware can feed generated or recorded input instead.
+	FString ReplayFile;
+	if (FParse::Value(FCommandLine::Get(), TEXT("RequenceReplay="), ReplayFile))
+	{
+		InitInput(MakeShareable(new FRequenceReplayInputSource(ReplayFile)), true);
+	}
+	else if (FParse::Param(FCommandLine::Get(), TEXT("RequenceSynthetic")))
+	{
+		InitInput(MakeShareable(new FRequenceSyntheticInputSource(FRequenceSyntheticInputConfig())), true);
+	}
+	else
+	{
+		InitInput(MakeShareable(new FRequenceSDLInputSource()), true);
 	}
-	Devices.Empty();
 
-	if (bOwnsSDL)
+	FString RecordFile;
+	if (FParse::Value(FCommandLine::Get(), TEXT("RequenceRecord="), RecordFile))
 	{
-		SDL_Quit();
+		StartRecording(RecordFile);
 	}
 }
 
-void RequenceInputDevice::InitSDL()
+RequenceInputDevice::RequenceInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler, const TSharedRef<IRequenceInputSource>& InSource, bool bThreaded, bool bInHeadless)
+	: bHeadless(bInHeadless), MessageHandler(InMessageHandler)
 {
-	UE_LOG(LogTemp, Log, TEXT("RequenceSDL starting"));
+	InitInput(InSource, bThreaded);
+}
 
-	if (SDL_WasInit(0) != 0)
+RequenceInputDevice::~RequenceInputDevice()
+{
+	//Stopping the thread closes all joysticks and releases the source.
+	if (InputThread.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("SDL already loaded!"));
-		bOwnsSDL = false;
+		InputThread->Shutdown();
+		InputThread.Reset();
 	}
-	else
+	else if (InputSource.IsValid())
 	{
-		SDL_Init(0);
-		bOwnsSDL = true;
-		UE_LOG(LogTemp, Log, TEXT("Took ownership of SDL"));
+		InputSource->Shutdown();
 	}
+	InputSource.Reset();
+	InputQueues.Reset();
+	Devices.Empty();
+	InstanceSlots.Empty();
+}
+
+void RequenceInputDevice::InitInput(const TSharedRef<IRequenceInputSource>& InSource, bool bThreaded)
+{
+	UE_LOG(LogTemp, Log, TEXT("Requence reading input from %s"), InSource->GetName());
 
-	if (SDL_InitSubSystem(SDL_INIT_JOYSTICK) == 0)
+	InputSource = InSource;
+	InputQueues = MakeUnique<FRequenceInputQueues>();
+
+	if (bThreaded)
 	{
-		UE_LOG(LogTemp, Log, TEXT("Initialized Joystick subsystem"));
+		InputThread = MakeUnique<FRequenceInputThread>(InSource, *InputQueues);
+		if (!InputThread->Start())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Requence failed to start its input thread!"));
+		}
 	}
-
-	if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) == 0)
+	else
 	{
-		UE_LOG(LogTemp, Log, TEXT("Initialized Controller subsystem"));
+		InSource->Init(*InputQueues);
 	}
 
-	for (int i = 0; i < SDL_NumJoysticks(); i++) 
+	//Headless devices run without physical axis settings, the save slot belongs to the real one.
+	if (!bHeadless)
 	{
-		AddDevice(i);
+		LoadRequenceDeviceProperties();
 	}
-
-	LoadRequenceDeviceProperties();
-
-	SDL_AddEventWatch(HandleSDLEvent, this);
 }
 
-int RequenceInputDevice::HandleSDLEvent(void* UserData, SDL_Event* Event)
+void RequenceInputDevice::HandleInputEvent(const FRequenceInputEvent& Event)
 {
-	RequenceInputDevice& Self = *static_cast<RequenceInputDevice*>(UserData);
-
-	switch (Event->type) 
+	switch (Event.Type)
 	{
-		case SDL_JOYDEVICEADDED:
-			Self.AddDevice(Event->jdevice.which);
-			break;
-		case SDL_JOYDEVICEREMOVED:
-			Self.RemDevice(Event->jdevice.which);
+		case ERequenceInputEventType::Button:
+			HandleInput_Button(Event);
 			break;
-		case SDL_JOYBUTTONDOWN:
-		case SDL_JOYBUTTONUP:
-			Self.HandleInput_Button(Event);
+		case ERequenceInputEventType::Hat:
+			HandleInput_Hat(Event);
 			break;
-		case SDL_JOYHATMOTION:
-			Self.HandleInput_Hat(Event);
-			break;
-		case SDL_JOYAXISMOTION:
-			Self.HandleInput_Axis(Event);
+		case ERequenceInputEventType::Axis:
+			HandleInput_Axis(Event);
 			break;
 		default:
 			break;
 	}
-
-	return 0;
 }
 
-bool RequenceInputDevice::AddDevice(int Which)
+bool RequenceInputDevice::AddDevice(const FRequenceDeviceDescriptor& Descriptor)
 {
-	if (SDL_IsGameController(Which) == SDL_TRUE) { return false; }
+	SCOPE_CYCLE_COUNTER(STAT_Requence_AddDevice);
 
 	//It's already in!
-	for (FSDLDeviceInfo d : Devices) {
-		if (d.Which == Which) { return false; }
-	}
-
-	FSDLDeviceInfo Device;
-	Device.Which = Which;
-	Device.Joystick = SDL_JoystickOpen(Which);
-	if (Device.Joystick == nullptr) {
-		return false;
-	}
-	Device.InstanceID = SDL_JoystickInstanceID(Device.Joystick);
-
-	Device.Name = FString(ANSI_TO_TCHAR(SDL_JoystickName(Device.Joystick))).Replace(TEXT("."), TEXT(""), ESearchCase::IgnoreCase);
-	UE_LOG(LogTemp, Log, TEXT("Requence input device connected: %s (which: %i, instance: %i)"), *Device.Name, Which, Device.InstanceID);
-	UE_LOG(LogTemp, Log, TEXT("- Axises %i"), SDL_JoystickNumAxes(Device.Joystick));
-	UE_LOG(LogTemp, Log, TEXT("- Buttons %i"), SDL_JoystickNumButtons(Device.Joystick));
-	UE_LOG(LogTemp, Log, TEXT("- Hats %i"), SDL_JoystickNumHats(Device.Joystick));
+	if (Descriptor.InstanceID < 0 || GetDeviceIndexByInstanceID(Descriptor.InstanceID) != -1) { return false; }
+
+	//Construct in place, FSDLDeviceInfo is too heavy to copy around.
+	int32 Slot = Devices.Add(FSDLDeviceInfo());
+	FSDLDeviceInfo& Device = Devices[Slot];
+	Device.Which = Descriptor.Which;
+	Device.InstanceID = Descriptor.InstanceID;
+	Device.Joystick = Descriptor.Joystick;
+	Device.Name = Descriptor.Name;
+	Device.HardwareID = Descriptor.HardwareID;
+	UE_LOG(LogTemp, Log, TEXT("Requence input device connected: %s (which: %i, instance: %i)"), *Device.Name, Device.Which, Device.InstanceID);
+	UE_LOG(LogTemp, Log, TEXT("- Axises %i"), Descriptor.NumAxises);
+	UE_LOG(LogTemp, Log, TEXT("- Buttons %i"), Descriptor.NumButtons);
+	UE_LOG(LogTemp, Log, TEXT("- Hats %i"), Descriptor.NumHats);
 
 	//Add Buttons
-	for (int i = 0; i < SDL_JoystickNumButtons(Device.Joystick); i++)
+	Device.Buttons.Reserve(Descriptor.NumButtons);
+	Device.OldButtonState.Init(false, Descriptor.NumButtons);
+	for (int i = 0; i < Descriptor.NumButtons; i++)
 	{
 		FString keyName = FString::Printf(TEXT("RequenceJoystick_%s_Button_%i"), *Device.Name, i);
 		FKey key{ *keyName };
-		Device.Buttons.Add(i, key);
-		Device.OldButtonState.Add(i, false);
+		Device.Buttons.Add(key);
 
 		//Add a new key if this one isn't there yet.
-		if (!EKeys::GetKeyDetails(key).IsValid())
+		if (RegisterDeviceKey(key))
 		{
 			FText textValue = FText::Format(LOCTEXT("DeviceHat", "RequenceJoystick {0} Button {1}"), FText::FromString(Device.Name), FText::AsNumber(i));
 			EKeys::AddKey(FKeyDetails(key, textValue, FKeyDetails::GamepadKey));
@@ -139,15 +164,19 @@ bool RequenceInputDevice::AddDevice(int Which)
 	}
 
 	//Add Axises
-	for (int i = 0; i < SDL_JoystickNumAxes(Device.Joystick); i++)
+	Device.Axises.Reserve(Descriptor.NumAxises);
+	Device.OldAxisState.Init(0.f, Descriptor.NumAxises);
+	Device.PendingAxisValue.Init(0, Descriptor.NumAxises);
+	Device.PendingAxisReceiveCycles.Init(0, Descriptor.NumAxises);
+	Device.PendingAxisDirty.Init(false, Descriptor.NumAxises);
+	for (int i = 0; i < Descriptor.NumAxises; i++)
 	{
 		FString keyName = FString::Printf(TEXT("RequenceJoystick_%s_Axis_%i"), *Device.Name, i);
 		FKey key{ *keyName };
-		Device.Axises.Add(i, key);
-		Device.OldAxisState.Add(i, 0.f);
+		Device.Axises.Add(key);
 
 		//Add a new key if this one isn't there yet.
-		if (!EKeys::GetKeyDetails(key).IsValid())
+		if (RegisterDeviceKey(key))
 		{
 			FText textValue = FText::Format(LOCTEXT("DeviceHat", "RequenceJoystick {0} Axis {1}"), FText::FromString(Device.Name), FText::AsNumber(i));
 			EKeys::AddKey(FKeyDetails(key, textValue, FKeyDetails::GamepadKey | FKeyDetails::FloatAxis));
@@ -155,36 +184,36 @@ bool RequenceInputDevice::AddDevice(int Which)
 	}
 
 	//Add HATS
-	for (int i = 0; i < SDL_JoystickNumHats(Device.Joystick); i++) 
+	Device.HatKeys.SetNum(Descriptor.NumHats);
+	Device.OldHatState.Init(SDL_HAT_CENTERED, Descriptor.NumHats);
+	for (int i = 0; i < Descriptor.NumHats; i++) 
 	{
-		Device.HatKeys.Add(i, FHatData());
-		Device.OldHatState.Add(i, 0);
+		Device.HatKeys[i].HatID = i;
 
 		//Buttons for all 8 keys
 		for (int j = 0; j < _HatDirections.Num(); j++) 
 		{
 			FString keyName = FString::Printf(TEXT("RequenceJoystick_%s_Hat_%i_%s"), *Device.Name, i, *_HatDirections[j]);
 			FKey key{ *keyName };
-			Device.HatKeys[i].Buttons.Add(_HatDirectionMap[j], key);
+			Device.HatKeys[i].Buttons[j] = key;
 
 			//Add a new key if this one isn't there yet.
-			if (!EKeys::GetKeyDetails(key).IsValid()) 
+			if (RegisterDeviceKey(key)) 
 			{
 				FText textValue = FText::Format(LOCTEXT("DeviceHat", "RequenceJoystick {0} Hat {1} {2}"), FText::FromString(Device.Name), FText::AsNumber(i), FText::FromString(_HatDirections[j]));
 				EKeys::AddKey(FKeyDetails(key, textValue, FKeyDetails::GamepadKey));
 			}
 		}
-		Device.HatKeys[i].Buttons.Add(SDL_HAT_CENTERED, FKey());
 
 		//Two axises.
 		for (int k = 0; k < _HatAxises.Num(); k++)
 		{
 			FString keyName = FString::Printf(TEXT("RequenceJoystick_%s_Hat_%i_%s-Axis"), *Device.Name, i, *_HatAxises[k]);
 			FKey key{ *keyName };
-			Device.HatKeys[i].Axises.Add(_HatAxises[k], key);
+			Device.HatKeys[i].Axises[k] = key;
 
 			//Add a new key if this one isn't there yet.
-			if (!EKeys::GetKeyDetails(key).IsValid())
+			if (RegisterDeviceKey(key))
 			{
 				FText textValue = FText::Format(LOCTEXT("DeviceHat", "RequenceJoystick {0} Hat {1} {2}-Axis"), FText::FromString(Device.Name), FText::AsNumber(i), FText::FromString(_HatAxises[k]));
 				EKeys::AddKey(FKeyDetails(key, textValue, FKeyDetails::GamepadKey | FKeyDetails::FloatAxis));
@@ -192,46 +221,62 @@ bool RequenceInputDevice::AddDevice(int Which)
 		}
 	}
 
-	Devices.Add(Device);
+	CompileAxisTransforms(Device);
+
+	//Lets ReportInputConsumed find a key's slot, so dispatching never hashes.
+	Device.KeyDispatchCycles.Init(0, Device.GetHatKeySlot(Device.HatKeys.Num(), 0));
+	for (int i = 0; i < Device.Buttons.Num(); i++) { KeySlots.Add(Device.Buttons[i], FIntPoint(Device.InstanceID, i)); }
+	for (int i = 0; i < Device.Axises.Num(); i++) { KeySlots.Add(Device.Axises[i], FIntPoint(Device.InstanceID, Device.GetAxisKeySlot(i))); }
+	for (int i = 0; i < Device.HatKeys.Num(); i++)
+	{
+		for (int j = 0; j < 8; j++) { KeySlots.Add(Device.HatKeys[i].Buttons[j], FIntPoint(Device.InstanceID, Device.GetHatKeySlot(i, j))); }
+		for (int k = 0; k < 2; k++) { KeySlots.Add(Device.HatKeys[i].Axises[k], FIntPoint(Device.InstanceID, Device.GetHatKeySlot(i, 8 + k))); }
+	}
+
+	while (InstanceSlots.Num() <= Device.InstanceID)
+	{
+		InstanceSlots.Add(INDEX_NONE);
+	}
+	InstanceSlots[Device.InstanceID] = Slot;
+
 	OnDevicesUpdated.Broadcast();
 	return true;
 }
 
 bool RequenceInputDevice::RemDevice(int InstanceID)
 {
-	bool found = false;
-	for (int i = Devices.Num()-1; i >= 0; i--) {
-		if (Devices[i].InstanceID == InstanceID) {
-			found = true;
-			UE_LOG(LogTemp, Log, TEXT("Requence input device disconnected: %s"), *Devices[i].Name);
+	int Slot = GetDeviceIndexByInstanceID(InstanceID);
+	bool found = Slot != -1;
+	if (found)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Requence input device disconnected: %s"), *Devices[Slot].Name);
 
-			if (Devices[i].Joystick != nullptr)
-			{
-				SDL_JoystickClose(Devices[i].Joystick);
-				Devices[i].Joystick = nullptr;
-			}
-			else { UE_LOG(LogTemp, Warning, TEXT("Tried to remove %s but the SDL device was a nullpointer! Cleaning up..."), *Devices[i].Name); }
+		//The input thread already closed the joystick.
+		Devices.RemoveAt(Slot);
+		InstanceSlots[InstanceID] = INDEX_NONE;
 
-			Devices.RemoveAt(i);
-			break;
+		for (auto It = KeySlots.CreateIterator(); It; ++It)
+		{
+			if (It.Value().X == InstanceID) { It.RemoveCurrent(); }
 		}
 	}
 
 	//return success.
 	OnDevicesUpdated.Broadcast();
-	return !found;
+	return found;
+}
+
+bool RequenceInputDevice::RegisterDeviceKey(const FKey& Key) const
+{
+	if (bHeadless) { return false; }
+
+	FRequenceKeyTypes::RegisterUniqueDeviceKey(Key);
+	return !EKeys::GetKeyDetails(Key).IsValid();
 }
 
 int RequenceInputDevice::GetDeviceIndexByInstanceID(int InstanceID)
 {
-	for (int i = 0; i < Devices.Num(); i++)
-	{
-		if (Devices[i].InstanceID == InstanceID)
-		{
-			return i;
-		}
-	}
-	return -1;
+	return InstanceSlots.IsValidIndex(InstanceID) ? InstanceSlots[InstanceID] : -1;
 }
 
 
@@ -245,185 +290,365 @@ void RequenceInputDevice::LoadRequenceDeviceProperties()
 
 	if (RSO_Instance->RequenceVersion != URequence::Version) { return; }
 
+	//The save object is thrown away after, so take over its devices.
 	DeviceProperties.Empty();
-	for (FRequenceSaveObjectDevice SavedDevice : RSO_Instance->Devices)
+	for (FRequenceSaveObjectDevice& SavedDevice : RSO_Instance->Devices)
 	{
 		if (SavedDevice.DeviceType != ERequenceDeviceType::RDT_Unique) { continue; }
 		for (int i = 0; i < SavedDevice.PhysicalAxises.Num(); i++) {
 			SavedDevice.PhysicalAxises[i].PrecacheDatapoints();
 		}
-		DeviceProperties.Add(SavedDevice);
+		DeviceProperties.Add(MoveTemp(SavedDevice));
+	}
+
+	for (FSDLDeviceInfo& Device : Devices)
+	{
+		CompileAxisTransforms(Device);
+	}
+}
+
+void RequenceInputDevice::SetPhysicalAxises(const FString& DeviceString, const TArray<FRequencePhysicalAxis>& PhysicalAxises)
+{
+	FRequenceSaveObjectDevice* Properties = DeviceProperties.FindByPredicate([&DeviceString](const FRequenceSaveObjectDevice& Each) { return Each.DeviceString == DeviceString; });
+	if (Properties == nullptr)
+	{
+		Properties = &DeviceProperties[DeviceProperties.AddDefaulted()];
+		Properties->DeviceString = DeviceString;
+		Properties->DeviceType = ERequenceDeviceType::RDT_Unique;
+	}
+
+	Properties->PhysicalAxises = PhysicalAxises;
+	for (FRequencePhysicalAxis& Axis : Properties->PhysicalAxises)
+	{
+		if (!Axis.bIsPrecached) { Axis.PrecacheDatapoints(); }
+	}
+
+	for (FSDLDeviceInfo& Device : Devices)
+	{
+		if (Device.Name == DeviceString) { CompileAxisTransforms(Device); }
+	}
+}
+
+void RequenceInputDevice::CompileAxisTransforms(FSDLDeviceInfo& Device) const
+{
+	Device.AxisTransforms.Reset();
+	Device.AxisTransforms.SetNum(Device.Axises.Num());
+
+	for (const FRequenceSaveObjectDevice& Properties : DeviceProperties)
+	{
+		//Check for the correct device, and if it has physicalAxis data stored.
+		if (Properties.DeviceString != Device.Name) { continue; }
+		if (Properties.PhysicalAxises.Num() <= 0) { continue; }
+
+		for (int AxisID = 0; AxisID < Device.AxisTransforms.Num() && AxisID < Properties.PhysicalAxises.Num(); AxisID++)
+		{
+			Device.AxisTransforms[AxisID] = FRequenceAxisTransform(Properties.PhysicalAxises[AxisID]);
+
+			if (bVerifyBakedCurves)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Requence baked curve of %s: max error %f"), *Properties.PhysicalAxises[AxisID].Axis, Properties.PhysicalAxises[AxisID].MeasureBakedCurveError());
+			}
+		}
+		break;
 	}
 }
 
-void RequenceInputDevice::HandleInput_Hat(SDL_Event* e)
+void RequenceInputDevice::HandleInput_Hat(const FRequenceInputEvent& e)
 {
-	if (!bOwnsSDL) { return; }
+	SCOPE_CYCLE_COUNTER(STAT_Requence_HandleInputHat);
+
+	//Axises that moved before this event go out first, so handlers see them in order.
+	if (DirtyAxises.Num() > 0) { FlushCoalescedAxises(); }
 
-	FVector2D HatInput = HatStateToVector(e->jhat.value);
-	int DevID = GetDeviceIndexByInstanceID(e->jdevice.which);
-	int HatID = e->jhat.hat;
+	int DevID = GetDeviceIndexByInstanceID(e.InstanceID);
+	int HatID = e.Index;
 
 	if (DevID == -1) { return; }
-	FVector2D OldHatState = HatStateToVector(Devices[DevID].OldHatState[HatID]);
+	FSDLDeviceInfo& Device = Devices[DevID];
+	if (!Device.HatKeys.IsValidIndex(HatID)) { return; }
+	Device.NumEvents++;
 
-	//Button
-	FKey ButtonKey = Devices[DevID].HatKeys[HatID].Buttons[e->jhat.value];
+	const FHatData& Hat = Device.HatKeys[HatID];
+	const FRequenceHatDirection& OldHat = DecodeHat(Device.OldHatState[HatID]);
+	const FRequenceHatDirection& NewHat = DecodeHat((uint8)e.Value);
+
+	RecordReceive(Device, e);
 
-	if (Devices[DevID].OldHatState.Num() > 0 && _HatDirectionMap.Contains(Devices[DevID].OldHatState[HatID]))
+	//Button
+	if (OldHat.Direction != INDEX_NONE)
 	{
 		//Up event for old hat
-		FKey OldKey = Devices[DevID].HatKeys[HatID].Buttons[
-			Devices[DevID].OldHatState[HatID]
-		];
-		FKeyEvent UpEvent(OldKey, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
-		FSlateApplication::Get().ProcessKeyUpEvent(UpEvent);
+		SendKeyUp(Hat.Buttons[OldHat.Direction]);
 	}
 
 	//down event for new hat, unless SDL_HAT_CENTERED
-	if (e->jhat.value != SDL_HAT_CENTERED)
+	if (NewHat.Direction != INDEX_NONE)
 	{
-		FKeyEvent DownEvent(ButtonKey, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
-		FSlateApplication::Get().ProcessKeyDownEvent(DownEvent);
+		SendKeyDown(Hat.Buttons[NewHat.Direction]);
+		RecordDispatch(Device, Device.GetHatKeySlot(HatID, NewHat.Direction), e.ReceiveCycles);
 	}
 
 	//Axis
-	if (OldHatState.X != HatInput.X) 
+	if (OldHat.X != NewHat.X) 
 	{
-		FKey XKey = Devices[DevID].HatKeys[HatID].Axises["X"];
-		FAnalogInputEvent XEvent(XKey, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0, HatInput.X);
-		FSlateApplication::Get().ProcessAnalogInputEvent(XEvent);
+		SendAnalog(Hat.Axises[0], NewHat.X);
+		RecordDispatch(Device, Device.GetHatKeySlot(HatID, 8), e.ReceiveCycles);
 	}
 
-	if (OldHatState.Y != HatInput.Y) 
+	if (OldHat.Y != NewHat.Y) 
 	{
-		FKey YKey = Devices[DevID].HatKeys[HatID].Axises["Y"];
-		FAnalogInputEvent YEvent(YKey, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0, HatInput.Y);
-		FSlateApplication::Get().ProcessAnalogInputEvent(YEvent);
+		SendAnalog(Hat.Axises[1], NewHat.Y);
+		RecordDispatch(Device, Device.GetHatKeySlot(HatID, 9), e.ReceiveCycles);
 	}
 
-	Devices[DevID].OldHatState[e->jhat.hat] = e->jhat.value;
+	Device.OldHatState[HatID] = (uint8)e.Value;
 }
 
-void RequenceInputDevice::HandleInput_Button(SDL_Event* e)
+void RequenceInputDevice::HandleInput_Button(const FRequenceInputEvent& e)
 {
-	if (!bOwnsSDL) { return; }
+	SCOPE_CYCLE_COUNTER(STAT_Requence_HandleInputButton);
 
-	int DevID = GetDeviceIndexByInstanceID(e->jdevice.which);
-	int ButtonID = e->jbutton.button;
-	bool NewButtonState = (e->jbutton.state > 0) ? true : false;
+	//Axises that moved before this event go out first, so handlers see them in order.
+	if (DirtyAxises.Num() > 0) { FlushCoalescedAxises(); }
+
+	int DevID = GetDeviceIndexByInstanceID(e.InstanceID);
+	int ButtonID = e.Index;
+	bool NewButtonState = (e.Value > 0) ? true : false;
 
 	if (DevID == -1) { return; }
-	if (!Devices[DevID].Buttons.Contains(ButtonID)) { return; }
+	FSDLDeviceInfo& Device = Devices[DevID];
+	if (!Device.Buttons.IsValidIndex(ButtonID)) { return; }
+	Device.NumEvents++;
+
+	RecordReceive(Device, e);
 
 	if (NewButtonState)
 	{
 		//Down event
-		FKeyEvent DownEvent(Devices[DevID].Buttons[ButtonID], 
-			FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
-		FSlateApplication::Get().ProcessKeyDownEvent(DownEvent);
+		SendKeyDown(Device.Buttons[ButtonID]);
 	}
 	else
 	{
 		//Up Event
-		FKeyEvent UpEvent(Devices[DevID].Buttons[ButtonID], 
-			FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
-		FSlateApplication::Get().ProcessKeyUpEvent(UpEvent);
+		SendKeyUp(Device.Buttons[ButtonID]);
 	}
+	RecordDispatch(Device, ButtonID, e.ReceiveCycles);
 
-	Devices[DevID].OldButtonState[ButtonID] = NewButtonState;
+	Device.OldButtonState[ButtonID] = NewButtonState;
 }
 
-void RequenceInputDevice::HandleInput_Axis(SDL_Event* e)
+void RequenceInputDevice::HandleInput_Axis(const FRequenceInputEvent& e)
 {
-	if (!bOwnsSDL) { return; }
+	SCOPE_CYCLE_COUNTER(STAT_Requence_HandleInputAxis);
 
-	int DevID = GetDeviceIndexByInstanceID(e->jdevice.which);
-	int AxisID = e->jaxis.axis;
-	float NewAxisState = FMath::Clamp(e->jaxis.value / (e->jaxis.value < 0 ? 32768.0f : 32767.0f), -1.f, 1.f);
+	int DevID = GetDeviceIndexByInstanceID(e.InstanceID);
+	int AxisID = e.Index;
 
 	if (DevID == -1) { return; }
+	FSDLDeviceInfo& Device = Devices[DevID];
+	if (!Device.Axises.IsValidIndex(AxisID)) { return; }
+	Device.NumEvents++;
+
+	RecordReceive(Device, e);
+
+	if (!bCoalesceAxisEvents)
+	{
+		DispatchAxis(Device, AxisID, e.Value, e.ReceiveCycles);
+		return;
+	}
+
+	//Keep only the latest position, FlushCoalescedAxises sends it.
+	if (!Device.PendingAxisDirty[AxisID])
+	{
+		Device.PendingAxisDirty[AxisID] = true;
+		DirtyAxises.Add(FIntPoint(e.InstanceID, AxisID));
+	}
+	Device.PendingAxisValue[AxisID] = e.Value;
+	Device.PendingAxisReceiveCycles[AxisID] = e.ReceiveCycles;
+}
+
+void RequenceInputDevice::DispatchAxis(FSDLDeviceInfo& Device, int AxisID, int16 RawValue, uint32 ReceiveCycles)
+{
+	float NewAxisState = FMath::Clamp(RawValue / (RawValue < 0 ? 32768.0f : 32767.0f), -1.f, 1.f);
 
 	//Filter based on Requence save file.
-	if (DeviceProperties.Num() > 0) {
-		for (int i = 0; i < DeviceProperties.Num(); i++)
-		{
-			//Check for the correct device, and if it has physicalAxis data stored.
-			if (DeviceProperties[i].DeviceString != Devices[DevID].Name) { continue; }
-			if (DeviceProperties[i].PhysicalAxises.Num() <= 0) { continue; }
-
-			switch (DeviceProperties[i].PhysicalAxises[AxisID].InputRange) {
-			case ERequencePAInputRange::RPAIR_Halved:
-				//Compress -1~1 to 0~1
-				NewAxisState = FMath::Clamp((NewAxisState + 1) / 2, 0.f, 1.f);
-				break;
-			case ERequencePAInputRange::RPAIR_HalvedNegative:
-				//Compress -1~1 to -1~0
-				NewAxisState = FMath::Clamp((NewAxisState - 1) / 2, -1.f, 0.f);
-				break;
-			default:
-				break;
-			}
+	float ChangeThreshold = 0.f;
+	if (Device.AxisTransforms.IsValidIndex(AxisID))
+	{
+		NewAxisState = Device.AxisTransforms[AxisID].Apply(NewAxisState, bVerifyBakedCurves);
+		ChangeThreshold = Device.AxisTransforms[AxisID].ChangeThreshold;
+	}
 
-			//If we have datapoints and they are precached, interpolate data.
-			if (DeviceProperties[i].PhysicalAxises[AxisID].DataPoints.Num() <= 0 && DeviceProperties[i].PhysicalAxises[AxisID].bIsPrecached) { continue; }
-			float interp = URequenceStructs::Interpolate(DeviceProperties[i].PhysicalAxises[AxisID].DataPoints, NewAxisState);
-			NewAxisState = interp;
-		}
+	//Suppress noise. Rest positions always get through so an axis can settle exactly.
+	if (bFilterAxisEvents)
+	{
+		float Delta = FMath::Abs(NewAxisState - Device.OldAxisState[AxisID]);
+		bool bIsRestPosition = NewAxisState == 0.f || FMath::Abs(NewAxisState) == 1.f;
+		if (Delta == 0.f || (Delta < ChangeThreshold && !bIsRestPosition)) { return; }
+	}
+
+	SendAnalog(Device.Axises[AxisID], NewAxisState);
+	INC_DWORD_STAT(STAT_Requence_NumAxisDispatches);
+	RecordDispatch(Device, Device.GetAxisKeySlot(AxisID), ReceiveCycles);
+
+	Device.OldAxisState[AxisID] = NewAxisState;
+}
+
+void RequenceInputDevice::FlushCoalescedAxises()
+{
+	SCOPE_CYCLE_COUNTER(STAT_Requence_FlushCoalescedAxises);
+	INC_DWORD_STAT_BY(STAT_Requence_NumCoalescedAxises, DirtyAxises.Num());
+
+	for (const FIntPoint& DirtyAxis : DirtyAxises)
+	{
+		//Device may have been removed in the meantime.
+		int DevID = GetDeviceIndexByInstanceID(DirtyAxis.X);
+		if (DevID == -1) { continue; }
+
+		FSDLDeviceInfo& Device = Devices[DevID];
+		Device.PendingAxisDirty[DirtyAxis.Y] = false;
+		DispatchAxis(Device, DirtyAxis.Y, Device.PendingAxisValue[DirtyAxis.Y], Device.PendingAxisReceiveCycles[DirtyAxis.Y]);
+	}
+	DirtyAxises.Reset();
+}
+
+float FRequenceAxisTransform::Apply(float Value, bool bVerify) const
+{
+	if (!bHasPhysicalData) { return Value; }
+
+	switch (InputRange) {
+	case ERequencePAInputRange::RPAIR_Halved:
+		//Compress -1~1 to 0~1
+		Value = FMath::Clamp((Value + 1) / 2, 0.f, 1.f);
+		break;
+	case ERequencePAInputRange::RPAIR_HalvedNegative:
+		//Compress -1~1 to -1~0
+		Value = FMath::Clamp((Value - 1) / 2, -1.f, 0.f);
+		break;
+	default:
+		break;
 	}
 
-	if (!Devices[DevID].Axises.Contains(AxisID)) { return; }
+	//Dead zone goes around the rest position, which is 0 for every range once remapped.
+	Value = FRequencePhysicalAxis::ApplyDeadZone(Value, DeadZone);
 
-	FAnalogInputEvent AxisEvent(Devices[DevID].Axises[AxisID], FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0, NewAxisState);
-	FSlateApplication::Get().ProcessAnalogInputEvent(AxisEvent);
+	//If we have a precached curve, interpolate data.
+	if (!Curve.IsValid()) { return Value; }
+	float Baked = Curve->Evaluate(Value);
 
-	Devices[DevID].OldAxisState[AxisID] = NewAxisState;
+	if (bVerify)
+	{
+		float Exact = Curve->EvaluateExact(Value);
+		if (FMath::Abs(Baked - Exact) > Curve->Tolerance)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Requence baked curve of %s is off by %f at %f (baked %f, exact %f)"), *AxisName.ToString(), Baked - Exact, Value, Baked, Exact);
+		}
+	}
+	return Baked;
 }
 
 FVector2D RequenceInputDevice::HatStateToVector(uint8 SDL_HAT_STATE)
 {
-	FVector2D HatInput;
+	const FRequenceHatDirection& Hat = DecodeHat(SDL_HAT_STATE);
+	return FVector2D(Hat.X, Hat.Y);
+}
+
+void RequenceInputDevice::RecordReceive(FSDLDeviceInfo& Device, const FRequenceInputEvent& e)
+{
+	if (!bTrackLatency || e.PollWaitCycles == 0) { return; }
+
+	Device.Latency.PollWait.AddSample(FRequenceLatencyTracker::CyclesToMicroseconds(e.PollWaitCycles));
+}
+
+void RequenceInputDevice::RecordDispatch(FSDLDeviceInfo& Device, const FKey& Key, uint32 ReceiveCycles)
+{
+	if (!bTrackLatency || ReceiveCycles == 0) { return; }
+
+	const uint32 Now = FPlatformTime::Cycles();
+	Device.Latency.ReceiveToDispatch.AddSample(FRequenceLatencyTracker::CyclesToMicroseconds(Now - ReceiveCycles));
 
-	switch (SDL_HAT_STATE)
+	if (bTrackConsumedLatency)
 	{
-		case SDL_HAT_CENTERED:
-			HatInput = FVector2D::ZeroVector;
-			break;
-		case SDL_HAT_DOWN:
-			HatInput.Y = -1;
-			HatInput.X = 0;
-			break;
-		case SDL_HAT_LEFTDOWN:
-			HatInput.Y = -1;
-			HatInput.X = -1;
-			break;
-		case SDL_HAT_LEFT:
-			HatInput.Y = 0;
-			HatInput.X = -1;
-			break;
-		case SDL_HAT_LEFTUP:
-			HatInput.Y = 1;
-			HatInput.X = -1;
-			break;
-		case SDL_HAT_UP:
-			HatInput.Y = 1;
-			HatInput.X = 0;
-			break;
-		case SDL_HAT_RIGHTUP:
-			HatInput.Y = 1;
-			HatInput.X = 1;
-			break;
-		case SDL_HAT_RIGHT:
-			HatInput.Y = 0;
-			HatInput.X = 1;
-			break;
-		case SDL_HAT_RIGHTDOWN:
-			HatInput.Y = -1;
-			HatInput.X = 1;
-			break;
+		//0 means consumed.
+		Device.KeyDispatchCycles[KeySlot] = FMath::Max(Now, 1u);
+	}
+}
+
+void RequenceInputDevice::ReportInputConsumed(const FKey& Key)
+{
+	bTrackConsumedLatency = true;
+
+	TArray<FIntPoint, TInlineAllocator<4>> Slots;
+	KeySlots.MultiFind(Key, Slots);
+
+	//Identical devices share key names, the latest dispatch is the one being used.
+	const uint32 Now = FPlatformTime::Cycles();
+	FSDLDeviceInfo* Latest = nullptr;
+	int32 LatestSlot = INDEX_NONE;
+	uint32 Elapsed = MAX_uint32;
+	for (const FIntPoint& Slot : Slots)
+	{
+		int DevID = GetDeviceIndexByInstanceID(Slot.X);
+		if (DevID == -1) { continue; }
+
+		const uint32 Dispatched = Devices[DevID].KeyDispatchCycles[Slot.Y];
+		if (Dispatched == 0 || Now - Dispatched >= Elapsed) { continue; }
+
+		Latest = &Devices[DevID];
+		LatestSlot = Slot.Y;
+		Elapsed = Now - Dispatched;
 	}
+	if (Latest == nullptr) { return; }
 
-	return HatInput;
+	//Only the first use of a dispatch counts, later ones measure the game rather than the input.
+	Latest->KeyDispatchCycles[LatestSlot] = 0;
+	Latest->Latency.DispatchToConsumed.AddSample(FRequenceLatencyTracker::CyclesToMicroseconds(Elapsed));
+}
+
+void RequenceInputDevice::GetLatency(TArray<FRequenceDeviceLatency>& OutLatency) const
+{
+	OutLatency.Reset(Devices.Num());
+	for (const FSDLDeviceInfo& Device : Devices)
+	{
+		FRequenceDeviceLatency& Latency = OutLatency[OutLatency.AddDefaulted()];
+		Latency.DeviceName = Device.Name;
+		Latency.PollWait = Device.Latency.PollWait.GetPercentiles();
+		Latency.ReceiveToDispatch = Device.Latency.ReceiveToDispatch.GetPercentiles();
+		Latency.DispatchToConsumed = Device.Latency.DispatchToConsumed.GetPercentiles();
+	}
+}
+
+void RequenceInputDevice::ResetLatency()
+{
+	for (FSDLDeviceInfo& Device : Devices)
+	{
+		Device.Latency.Reset();
+		Device.KeyDispatchCycles.Init(0, Device.KeyDispatchCycles.Num());
+	}
+}
+
+void RequenceInputDevice::SendKeyDown(const FKey& Key)
+{
+	if (bHeadless || !FSlateApplication::IsInitialized()) { return; }
+
+	FKeyEvent DownEvent(Key, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
+	FSlateApplication::Get().ProcessKeyDownEvent(DownEvent);
+}
+
+void RequenceInputDevice::SendKeyUp(const FKey& Key)
+{
+	if (bHeadless || !FSlateApplication::IsInitialized()) { return; }
+
+	FKeyEvent UpEvent(Key, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0);
+	FSlateApplication::Get().ProcessKeyUpEvent(UpEvent);
+}
+
+void RequenceInputDevice::SendAnalog(const FKey& Key, float Value)
+{
+	if (bHeadless || !FSlateApplication::IsInitialized()) { return; }
+
+	FAnalogInputEvent AnalogEvent(Key, FSlateApplication::Get().GetModifierKeys(), 0, false, 0, 0, Value);
+	FSlateApplication::Get().ProcessAnalogInputEvent(AnalogEvent);
 }
 
 void RequenceInputDevice::Tick(float DeltaTime)
@@ -433,11 +658,279 @@ void RequenceInputDevice::Tick(float DeltaTime)
 
 void RequenceInputDevice::SendControllerEvents()
 {
-	if (bOwnsSDL)
+	SCOPE_CYCLE_COUNTER(STAT_Requence_SendControllerEvents);
+	if (!InputQueues.IsValid()) { return; }
+
+	//Not threaded, pump the source ourselves.
+	if (!InputThread.IsValid() && InputSource.IsValid())
+	{
+		InputSource->Pump(*InputQueues);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (bTrackLatency)
+	{
+		for (FSDLDeviceInfo& Device : Devices)
+		{
+			Device.Latency.Tick(Now);
+		}
+	}
+
+	if (Now - LastEventRateTime >= 1.0)
+	{
+		for (FSDLDeviceInfo& Device : Devices)
+		{
+			Device.EventRate = (Device.NumEvents - Device.NumEventsAtLastRate) / (Now - LastEventRateTime);
+			Device.NumEventsAtLastRate = Device.NumEvents;
+		}
+		LastEventRateTime = Now;
+	}
+
+	//Hotplug first, so events of a freshly connected device find it.
+	FRequenceDeviceDescriptor Descriptor;
+	while (InputQueues->AddedDevices.Dequeue(Descriptor))
+	{
+		if (AddDevice(Descriptor))
+		{
+			Recorder.RecordDeviceAdded(Descriptor);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_Requence_EventQueueDepth, InputQueues->Events.Num());
+	SET_DWORD_STAT(STAT_Requence_NumDroppedEvents, InputQueues->Events.GetDroppedCount());
+
+	FRequenceInputEvent Event;
+	while (InputQueues->Events.Pop(Event))
+	{
+		Recorder.RecordEvent(Event);
+		HandleInputEvent(Event);
+		INC_DWORD_STAT(STAT_Requence_NumEvents);
+	}
+	FlushCoalescedAxises();
+	Recorder.RecordFrame();
+
+	int32 InstanceID;
+	while (InputQueues->RemovedDevices.Dequeue(InstanceID))
+	{
+		Recorder.RecordDeviceRemoved(InstanceID);
+		RemDevice(InstanceID);
+	}
+
+	SET_DWORD_STAT(STAT_Requence_NumDevices, Devices.Num());
+}
+
+bool RequenceInputDevice::StartRecording(const FString& Filename)
+{
+	if (!Recorder.Start(Filename)) { return false; }
+
+	//Devices connected before the recording started.
+	for (const FSDLDeviceInfo& Device : Devices)
+	{
+		FRequenceDeviceDescriptor Descriptor;
+		Descriptor.Which = Device.Which;
+		Descriptor.InstanceID = Device.InstanceID;
+		Descriptor.Name = Device.Name;
+		Descriptor.HardwareID = Device.HardwareID;
+		Descriptor.NumAxises = Device.Axises.Num();
+		Descriptor.NumButtons = Device.Buttons.Num();
+		Descriptor.NumHats = Device.HatKeys.Num();
+		Recorder.RecordDeviceAdded(Descriptor);
+	}
+	return true;
+}
+
+void RequenceInputDevice::StopRecording()
+{
+	Recorder.Stop();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Console commands
+//////////////////////////////////////////////////////////////////////////
+
+//Reads On/Off (or 1/0, True/False) from Cmd, flips Current when there is no argument.
+static bool ParseToggle(const TCHAR*& Cmd, bool Current)
+{
+	FString Arg = FParse::Token(Cmd, false);
+	return Arg.IsEmpty() ? !Current : FCString::ToBool(*Arg);
+}
+
+bool RequenceInputDevice::Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (!FParse::Command(&Cmd, TEXT("Requence"))) { return false; }
+
+	if (FParse::Command(&Cmd, TEXT("Devices")))
+	{
+		ExecDevices(Ar);
+	}
+	else if (FParse::Command(&Cmd, TEXT("Rates")))
+	{
+		ExecRates(Ar);
+	}
+	else if (FParse::Command(&Cmd, TEXT("Latency")))
+	{
+		ExecLatency(Cmd, Ar);
+	}
+	else if (FParse::Command(&Cmd, TEXT("Coalesce")))
+	{
+		bCoalesceAxisEvents = ParseToggle(Cmd, bCoalesceAxisEvents);
+		if (!bCoalesceAxisEvents) { FlushCoalescedAxises(); }
+		Ar.Logf(TEXT("Requence axis coalescing %s"), bCoalesceAxisEvents ? TEXT("on") : TEXT("off"));
+	}
+	else if (FParse::Command(&Cmd, TEXT("Filter")))
+	{
+		bFilterAxisEvents = ParseToggle(Cmd, bFilterAxisEvents);
+		Ar.Logf(TEXT("Requence axis filtering %s"), bFilterAxisEvents ? TEXT("on") : TEXT("off"));
+	}
+	else if (FParse::Command(&Cmd, TEXT("VerifyCurves")))
+	{
+		bVerifyBakedCurves = ParseToggle(Cmd, bVerifyBakedCurves);
+		Ar.Logf(TEXT("Requence baked curve verification %s"), bVerifyBakedCurves ? TEXT("on") : TEXT("off"));
+	}
+	else if (FParse::Command(&Cmd, TEXT("Record")))
+	{
+		ExecRecord(Cmd, Ar);
+	}
+	else if (FParse::Command(&Cmd, TEXT("Bench")))
+	{
+		ExecBench(Cmd, Ar);
+	}
+	else
+	{
+		Ar.Log(TEXT("Requence Devices                       Connected devices and their axis, button and hat state"));
+		Ar.Log(TEXT("Requence Rates                         Events per second and dropped events per device"));
+		Ar.Log(TEXT("Requence Latency [Reset]               Input latency percentiles per device"));
+		Ar.Log(TEXT("Requence Coalesce|Filter|VerifyCurves [On|Off]"));
+		Ar.Log(TEXT("Requence Record [Start [File]|Stop]    Records input, see -RequenceRecord"));
+		Ar.Log(TEXT("Requence Bench [Events=N] [Replay=File] Runs the input microbenchmarks"));
+	}
+	return true;
+}
+
+void RequenceInputDevice::ExecDevices(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Requence: %i device(s), reading from %s"), Devices.Num(), InputSource.IsValid() ? InputSource->GetName() : TEXT("nothing"));
+
+	for (const FSDLDeviceInfo& Device : Devices)
+	{
+		Ar.Logf(TEXT("%s (which: %i, instance: %i)"), *Device.Name, Device.Which, Device.InstanceID);
+
+		for (int i = 0; i < Device.Axises.Num(); i++)
+		{
+			const bool bHasPhysicalData = Device.AxisTransforms.IsValidIndex(i) && Device.AxisTransforms[i].bHasPhysicalData;
+			Ar.Logf(TEXT("  Axis %2i: %+.4f%s"), i, Device.OldAxisState[i], bHasPhysicalData ? TEXT(" (physical data)") : TEXT(""));
+		}
+
+		FString ButtonsDown;
+		for (TConstSetBitIterator<> It(Device.OldButtonState); It; ++It)
+		{
+			ButtonsDown += FString::Printf(TEXT(" %i"), It.GetIndex());
+		}
+		Ar.Logf(TEXT("  Buttons: %i, down:%s"), Device.Buttons.Num(), ButtonsDown.IsEmpty() ? TEXT(" none") : *ButtonsDown);
+
+		for (int i = 0; i < Device.OldHatState.Num(); i++)
+		{
+			const FRequenceHatDirection& Hat = DecodeHat(Device.OldHatState[i]);
+			Ar.Logf(TEXT("  Hat %i: %s"), i, Hat.Direction != INDEX_NONE ? *_HatDirections[Hat.Direction] : TEXT("Centered"));
+		}
+	}
+}
+
+void RequenceInputDevice::ExecRates(FOutputDevice& Ar) const
+{
+	for (const FSDLDeviceInfo& Device : Devices)
+	{
+		Ar.Logf(TEXT("%s: %.0f events/s, %lld handled, %i dropped"), *Device.Name, Device.EventRate, Device.NumEvents,
+			InputQueues.IsValid() ? InputQueues->GetDroppedEvents(Device.InstanceID) : 0);
+	}
+
+	if (InputQueues.IsValid())
+	{
+		Ar.Logf(TEXT("Queue: %i of %u queued, %i dropped in total"), InputQueues->Events.Num(), FRequenceInputQueues::EventCapacity, InputQueues->Events.GetDroppedCount());
+	}
+}
+
+void RequenceInputDevice::ExecLatency(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (FParse::Command(&Cmd, TEXT("Reset")))
+	{
+		ResetLatency();
+		Ar.Log(TEXT("Requence latency reset"));
+		return;
+	}
+
+	TArray<FRequenceDeviceLatency> Latency;
+	GetLatency(Latency);
+
+	Ar.Logf(TEXT("%-32s %-20s %8s %8s %8s %8s %8s"), TEXT("Device"), TEXT("Stage (ms)"), TEXT("Samples"), TEXT("P50"), TEXT("P90"), TEXT("P99"), TEXT("Max"));
+	for (const FRequenceDeviceLatency& Device : Latency)
 	{
-		SDL_Event Event;
-		while (SDL_PollEvent(&Event)) {}
+		const TCHAR* StageNames[] = { TEXT("Poll wait (max)"), TEXT("Receive to dispatch"), TEXT("Dispatch to consumed") };
+		const FRequenceLatencyPercentiles* Stages[] = { &Device.PollWait, &Device.ReceiveToDispatch, &Device.DispatchToConsumed };
+		for (int i = 0; i < ARRAY_COUNT(Stages); i++)
+		{
+			Ar.Logf(TEXT("%-32s %-20s %8i %8.3f %8.3f %8.3f %8.3f"), *Device.DeviceName, StageNames[i], Stages[i]->NumSamples,
+				Stages[i]->P50, Stages[i]->P90, Stages[i]->P99, Stages[i]->Max);
+		}
+	}
+}
+
+void RequenceInputDevice::ExecRecord(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	if (FParse::Command(&Cmd, TEXT("Start")))
+	{
+		FString Filename = FParse::Token(Cmd, false);
+		if (Filename.IsEmpty())
+		{
+			Filename = TEXT("Requence_") + FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"));
+		}
+
+		if (StartRecording(Filename))
+		{
+			Ar.Logf(TEXT("Requence recording to %s"), *Recorder.GetFilename());
+		}
+		else
+		{
+			Ar.Logf(TEXT("Requence could not record to %s"), *Filename);
+		}
 	}
+	else if (FParse::Command(&Cmd, TEXT("Stop")))
+	{
+		if (!IsRecording())
+		{
+			Ar.Log(TEXT("Requence is not recording"));
+			return;
+		}
+
+		StopRecording();
+		Ar.Logf(TEXT("Requence saved %lld records to %s"), Recorder.GetNumRecords(), *Recorder.GetFilename());
+	}
+	else if (IsRecording())
+	{
+		Ar.Logf(TEXT("Requence recording to %s, %lld records so far"), *Recorder.GetFilename(), Recorder.GetNumRecords());
+	}
+	else
+	{
+		Ar.Log(TEXT("Requence is not recording"));
+	}
+}
+
+void RequenceInputDevice::ExecBench(const TCHAR* Cmd, FOutputDevice& Ar)
+{
+	int32 NumEvents = FRequenceBenchmark::DefaultNumEvents;
+	FParse::Value(Cmd, TEXT("Events="), NumEvents);
+	NumEvents = FMath::Max(NumEvents, 1);
+
+	//Runs on its own headless device: ours keeps its state and nothing reaches the game.
+	TArray<FRequenceBenchmarkResult> Results = FRequenceBenchmark::RunInputBenchmark(NumEvents);
+
+	FString ReplayFile;
+	if (FParse::Value(Cmd, TEXT("Replay="), ReplayFile))
+	{
+		Results.Add(FRequenceBenchmark::RunReplayBenchmark(ReplayFile));
+	}
+
+	FRequenceBenchmark::PrintResults(Results, Ar);
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,287 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceInputRecording.h"
+#include "RequenceInputDevice.h"
+#include "FileHelper.h"
+#include "FileManager.h"
+#include "MemoryReader.h"
+#include "PlatformTime.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Recorder
+//////////////////////////////////////////////////////////////////////////
+
+FString FRequenceInputRecorder::GetRecordingFilePath(const FString& Filename)
+{
+	FString Path = FPaths::IsRelative(Filename) ? GetDefaultRecordingPath() + Filename : Filename;
+	if (!Path.EndsWith(TEXT(".rqin")))
+	{
+		Path += TEXT(".rqin");
+	}
+	return Path;
+}
+
+bool FRequenceInputRecorder::Start(const FString& InFilename)
+{
+	Stop();
+
+	Filename = GetRecordingFilePath(InFilename);
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+
+	Writer = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Requence could not record to %s"), *Filename);
+		return false;
+	}
+
+	uint32 HeaderMagic = Magic;
+	uint32 HeaderVersion = Version;
+	*Writer << HeaderMagic;
+	*Writer << HeaderVersion;
+
+	NumRecords = 0;
+	bEventsSinceFrame = false;
+	UE_LOG(LogTemp, Log, TEXT("Requence recording input to %s"), *Filename);
+	return true;
+}
+
+void FRequenceInputRecorder::Stop()
+{
+	if (!Writer.IsValid()) { return; }
+
+	RecordFrame();
+	Writer->Close();
+	Writer.Reset();
+	UE_LOG(LogTemp, Log, TEXT("Requence stopped recording, %lld records in %s"), NumRecords, *Filename);
+}
+
+void FRequenceInputRecorder::RecordEvent(const FRequenceInputEvent& Event)
+{
+	if (!Writer.IsValid()) { return; }
+
+	uint8 Kind = (uint8)ERequenceRecordKind::Event;
+	FRequenceInputEvent Record = Event;
+	*Writer << Kind;
+	SerializeEvent(*Writer, Record);
+	NumRecords++;
+	bEventsSinceFrame = true;
+}
+
+void FRequenceInputRecorder::RecordDeviceAdded(const FRequenceDeviceDescriptor& Descriptor)
+{
+	if (!Writer.IsValid()) { return; }
+
+	uint8 Kind = (uint8)ERequenceRecordKind::DeviceAdded;
+	FRequenceDeviceDescriptor Record = Descriptor;
+	*Writer << Kind;
+	SerializeDevice(*Writer, Record);
+	NumRecords++;
+}
+
+void FRequenceInputRecorder::RecordDeviceRemoved(int32 InstanceID)
+{
+	if (!Writer.IsValid()) { return; }
+
+	uint8 Kind = (uint8)ERequenceRecordKind::DeviceRemoved;
+	*Writer << Kind;
+	*Writer << InstanceID;
+	NumRecords++;
+}
+
+void FRequenceInputRecorder::RecordFrame()
+{
+	//Frames without events change nothing on replay, leave them out.
+	if (!Writer.IsValid() || !bEventsSinceFrame) { return; }
+
+	uint8 Kind = (uint8)ERequenceRecordKind::Frame;
+	*Writer << Kind;
+	NumRecords++;
+	bEventsSinceFrame = false;
+}
+
+void FRequenceInputRecorder::SerializeEvent(FArchive& Ar, FRequenceInputEvent& Event)
+{
+	uint8 Type = (uint8)Event.Type;
+	Ar << Event.Timestamp;
+	Ar << Event.InstanceID;
+	Ar << Type;
+	Ar << Event.Index;
+	Ar << Event.Value;
+	Event.Type = (ERequenceInputEventType)Type;
+}
+
+void FRequenceInputRecorder::SerializeDevice(FArchive& Ar, FRequenceDeviceDescriptor& Descriptor)
+{
+	int32 Which = Descriptor.Which;
+	int32 InstanceID = Descriptor.InstanceID;
+	int32 NumAxises = Descriptor.NumAxises;
+	int32 NumButtons = Descriptor.NumButtons;
+	int32 NumHats = Descriptor.NumHats;
+	Ar << Which;
+	Ar << InstanceID;
+	Ar << Descriptor.Name;
+	Ar << NumAxises;
+	Ar << NumButtons;
+	Ar << NumHats;
+
+	if (Ar.IsLoading())
+	{
+		Descriptor.Which = Which;
+		Descriptor.InstanceID = InstanceID;
+		Descriptor.NumAxises = NumAxises;
+		Descriptor.NumButtons = NumButtons;
+		Descriptor.NumHats = NumHats;
+		Descriptor.Joystick = nullptr;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Player
+//////////////////////////////////////////////////////////////////////////
+
+bool FRequenceInputPlayer::Load(const FString& Filename)
+{
+	Data.Reset();
+	Position = 0;
+
+	//Recordings are small next to what the engine loads anyway, so read them in one go.
+	const FString Path = FRequenceInputRecorder::GetRecordingFilePath(Filename);
+	if (!FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Requence could not open recording %s"), *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	uint32 HeaderMagic = 0;
+	uint32 HeaderVersion = 0;
+	Reader << HeaderMagic;
+	Reader << HeaderVersion;
+	if (Reader.IsError() || HeaderMagic != FRequenceInputRecorder::Magic || HeaderVersion != FRequenceInputRecorder::Version)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Requence can not play %s, not a version %u recording"), *Path, FRequenceInputRecorder::Version);
+		Data.Reset();
+		return false;
+	}
+
+	Position = HeaderSize;
+	return true;
+}
+
+bool FRequenceInputPlayer::ReadNext(FRequenceInputRecord& OutRecord)
+{
+	if (Position >= Data.Num()) { return false; }
+
+	FMemoryReader Reader(Data);
+	Reader.Seek(Position);
+
+	uint8 Kind = 0;
+	Reader << Kind;
+	OutRecord.Kind = (ERequenceRecordKind)Kind;
+
+	switch (OutRecord.Kind)
+	{
+		case ERequenceRecordKind::Event:
+			FRequenceInputRecorder::SerializeEvent(Reader, OutRecord.Event);
+			break;
+		case ERequenceRecordKind::DeviceAdded:
+			FRequenceInputRecorder::SerializeDevice(Reader, OutRecord.Device);
+			break;
+		case ERequenceRecordKind::DeviceRemoved:
+			Reader << OutRecord.Device.InstanceID;
+			break;
+		case ERequenceRecordKind::Frame:
+			break;
+		default:
+			Position = Data.Num();
+			return false;
+	}
+
+	//Truncated, stop here.
+	if (Reader.IsError())
+	{
+		Position = Data.Num();
+		return false;
+	}
+
+	Position = Reader.Tell();
+	return true;
+}
+
+int64 FRequenceInputPlayer::Replay(RequenceInputDevice& Device)
+{
+	int64 NumEvents = 0;
+	FRequenceInputRecord Record;
+	while (ReadNext(Record))
+	{
+		switch (Record.Kind)
+		{
+			case ERequenceRecordKind::Event:
+				Device.HandleInputEvent(Record.Event);
+				NumEvents++;
+				break;
+			case ERequenceRecordKind::DeviceAdded:
+				Device.AddDevice(Record.Device);
+				break;
+			case ERequenceRecordKind::DeviceRemoved:
+				Device.RemDevice(Record.Device.InstanceID);
+				break;
+			case ERequenceRecordKind::Frame:
+				Device.FlushCoalescedAxises();
+				break;
+		}
+	}
+	Device.FlushCoalescedAxises();
+	return NumEvents;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Replay source
+//////////////////////////////////////////////////////////////////////////
+
+bool FRequenceReplayInputSource::Init(FRequenceInputQueues& Queues)
+{
+	if (!Player.Load(Filename)) { return false; }
+
+	StartTime = FPlatformTime::Seconds();
+	FirstTimestamp = -1;
+	bHasPending = false;
+	Pump(Queues);
+	return true;
+}
+
+void FRequenceReplayInputSource::Pump(FRequenceInputQueues& Queues)
+{
+	if (!Player.IsLoaded()) { return; }
+
+	const int64 ElapsedMs = (int64)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	while (bHasPending || Player.ReadNext(Pending))
+	{
+		bHasPending = false;
+
+		switch (Pending.Kind)
+		{
+			case ERequenceRecordKind::Event:
+				//Time is relative to the first event, so playback starts right away.
+				if (FirstTimestamp < 0) { FirstTimestamp = Pending.Event.Timestamp; }
+				if ((int64)Pending.Event.Timestamp - FirstTimestamp > ElapsedMs)
+				{
+					bHasPending = true;
+					return;
+				}
+				Pending.Event.ReceiveCycles = FPlatformTime::Cycles();
+				Queues.PushEvent(Pending.Event);
+				break;
+			case ERequenceRecordKind::DeviceAdded:
+				Queues.AddedDevices.Enqueue(Pending.Device);
+				break;
+			case ERequenceRecordKind::DeviceRemoved:
+				Queues.RemovedDevices.Enqueue(Pending.Device.InstanceID);
+				break;
+			case ERequenceRecordKind::Frame:
+				break;
+		}
+	}
+}
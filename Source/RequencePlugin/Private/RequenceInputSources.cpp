@@ -0,0 +1,386 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceInputSources.h"
+#include "PlatformTime.h"
+#include "RequenceStats.h"
+
+//////////////////////////////////////////////////////////////////////////
+// SDL
+//////////////////////////////////////////////////////////////////////////
+
+bool FRequenceSDLInputSource::Init(FRequenceInputQueues& Queues)
+{
+	UE_LOG(LogTemp, Log, TEXT("RequenceSDL starting"));
+
+	if (SDL_WasInit(0) != 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SDL already loaded!"));
+		bOwnsSDL = false;
+	}
+	else
+	{
+		SDL_Init(0);
+		bOwnsSDL = true;
+		UE_LOG(LogTemp, Log, TEXT("Took ownership of SDL"));
+	}
+
+	if (SDL_InitSubSystem(SDL_INIT_JOYSTICK) == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Initialized Joystick subsystem"));
+	}
+
+	if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) == 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Initialized Controller subsystem"));
+	}
+
+	for (int i = 0; i < SDL_NumJoysticks(); i++)
+	{
+		OpenDevice(i, Queues);
+	}
+
+	return true;
+}
+
+void FRequenceSDLInputSource::Pump(FRequenceInputQueues& Queues)
+{
+	//SDL stamps joystick events while we poll, so their timestamps can't tell how long they waited.
+	//All we know is that they came in after the previous drain.
+	const uint32 PollCycles = FPlatformTime::Cycles();
+	PollWaitCycles = LastDrainCycles != 0 ? PollCycles - LastDrainCycles : 0;
+
+	if (bOwnsSDL)
+	{
+		SDL_Event Event;
+		while (SDL_PollEvent(&Event))
+		{
+			HandleSDLEvent(Event, Queues);
+		}
+	}
+	else
+	{
+		//Someone else pumps SDL, polling events here would steal theirs.
+		PollJoysticks(Queues);
+	}
+	LastDrainCycles = FPlatformTime::Cycles();
+}
+
+void FRequenceSDLInputSource::PollJoysticks(FRequenceInputQueues& Queues)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+	//The owner may be pumping at the same time, the joystick lock keeps SDL_JoystickUpdate safe against that.
+	SDL_LockJoysticks();
+	SDL_JoystickUpdate();
+#endif
+	//Older SDL has no lock, so the state is only as fresh as the owner's last pump.
+
+	//Hotplug events go to the owner as well, so watch the device list instead.
+	const int32 NumJoysticks = SDL_NumJoysticks();
+	if (bRescanJoysticks || NumJoysticks != LastNumJoysticks)
+	{
+		for (int i = 0; i < NumJoysticks; i++)
+		{
+			OpenDevice(i, Queues);
+		}
+		LastNumJoysticks = NumJoysticks;
+		bRescanJoysticks = false;
+	}
+
+	TArray<int32, TInlineAllocator<8>> Detached;
+	const uint32 Timestamp = SDL_GetTicks();
+	for (const auto& Joystick : Joysticks)
+	{
+		if (!SDL_JoystickGetAttached(Joystick.Value))
+		{
+			Detached.Add(Joystick.Key);
+			continue;
+		}
+
+		FRequencePolledJoystick* State = PolledJoysticks.Find(Joystick.Key);
+		if (State == nullptr) { continue; }
+
+		for (int32 i = 0; i < State->Axises.Num(); i++)
+		{
+			const int16 Value = SDL_JoystickGetAxis(Joystick.Value, i);
+			if (Value == State->Axises[i]) { continue; }
+			State->Axises[i] = Value;
+			PushPolledEvent(Queues, Joystick.Key, ERequenceInputEventType::Axis, i, Value, Timestamp);
+		}
+		for (int32 i = 0; i < State->Buttons.Num(); i++)
+		{
+			const uint8 Value = SDL_JoystickGetButton(Joystick.Value, i);
+			if (Value == State->Buttons[i]) { continue; }
+			State->Buttons[i] = Value;
+			PushPolledEvent(Queues, Joystick.Key, ERequenceInputEventType::Button, i, Value, Timestamp);
+		}
+		for (int32 i = 0; i < State->Hats.Num(); i++)
+		{
+			const uint8 Value = SDL_JoystickGetHat(Joystick.Value, i);
+			if (Value == State->Hats[i]) { continue; }
+			State->Hats[i] = Value;
+			PushPolledEvent(Queues, Joystick.Key, ERequenceInputEventType::Hat, i, Value, Timestamp);
+		}
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+	SDL_UnlockJoysticks();
+#endif
+
+	for (int32 InstanceID : Detached)
+	{
+		CloseDevice(InstanceID, Queues);
+		bRescanJoysticks = true;
+	}
+}
+
+void FRequenceSDLInputSource::PushPolledEvent(FRequenceInputQueues& Queues, int32 InstanceID, ERequenceInputEventType Type, int32 Index, int16 Value, uint32 Timestamp)
+{
+	FRequenceInputEvent Record;
+	Record.Timestamp = Timestamp;
+	Record.InstanceID = InstanceID;
+	Record.Type = Type;
+	Record.Index = Index;
+	Record.Value = Value;
+	Record.PollWaitCycles = PollWaitCycles;
+	Record.ReceiveCycles = FPlatformTime::Cycles();
+	Queues.PushEvent(Record);
+}
+
+void FRequenceSDLInputSource::Shutdown()
+{
+	UE_LOG(LogTemp, Log, TEXT("Quitting SDL."));
+
+	for (auto& Joystick : Joysticks)
+	{
+		SDL_JoystickClose(Joystick.Value);
+	}
+	Joysticks.Empty();
+	PolledJoysticks.Empty();
+
+	if (bOwnsSDL)
+	{
+		SDL_Quit();
+	}
+}
+
+void FRequenceSDLInputSource::HandleSDLEvent(const SDL_Event& Event, FRequenceInputQueues& Queues)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Requence_HandleSDLEvent);
+
+	FRequenceInputEvent Record;
+	Record.Timestamp = Event.common.timestamp;
+
+	switch (Event.type)
+	{
+		case SDL_JOYDEVICEADDED:
+			OpenDevice(Event.jdevice.which, Queues);
+			return;
+		case SDL_JOYDEVICEREMOVED:
+			CloseDevice(Event.jdevice.which, Queues);
+			return;
+		case SDL_JOYBUTTONDOWN:
+		case SDL_JOYBUTTONUP:
+			Record.InstanceID = Event.jbutton.which;
+			Record.Type = ERequenceInputEventType::Button;
+			Record.Index = Event.jbutton.button;
+			Record.Value = Event.jbutton.state;
+			break;
+		case SDL_JOYHATMOTION:
+			Record.InstanceID = Event.jhat.which;
+			Record.Type = ERequenceInputEventType::Hat;
+			Record.Index = Event.jhat.hat;
+			Record.Value = Event.jhat.value;
+			break;
+		case SDL_JOYAXISMOTION:
+			Record.InstanceID = Event.jaxis.which;
+			Record.Type = ERequenceInputEventType::Axis;
+			Record.Index = Event.jaxis.axis;
+			Record.Value = Event.jaxis.value;
+			break;
+		default:
+			return;
+	}
+
+	Record.PollWaitCycles = PollWaitCycles;
+	Record.ReceiveCycles = FPlatformTime::Cycles();
+	Queues.PushEvent(Record);
+}
+
+void FRequenceSDLInputSource::OpenDevice(int Which, FRequenceInputQueues& Queues)
+{
+	if (SDL_IsGameController(Which) == SDL_TRUE) { return; }
+
+	SDL_Joystick* Joystick = SDL_JoystickOpen(Which);
+	if (Joystick == nullptr) { return; }
+
+	//It's already in! SDL refcounts opened joysticks, so drop the extra reference.
+	int32 InstanceID = SDL_JoystickInstanceID(Joystick);
+	if (Joysticks.Contains(InstanceID))
+	{
+		SDL_JoystickClose(Joystick);
+		return;
+	}
+	Joysticks.Add(InstanceID, Joystick);
+
+	FRequenceDeviceDescriptor Descriptor;
+	Descriptor.Which = Which;
+	Descriptor.InstanceID = InstanceID;
+	Descriptor.Joystick = Joystick;
+	Descriptor.Name = FString(ANSI_TO_TCHAR(SDL_JoystickName(Joystick))).Replace(TEXT("."), TEXT(""), ESearchCase::IgnoreCase);
+	Descriptor.NumAxises = SDL_JoystickNumAxes(Joystick);
+	Descriptor.NumButtons = SDL_JoystickNumButtons(Joystick);
+	Descriptor.NumHats = SDL_JoystickNumHats(Joystick);
+
+	//Identifies the model, so a device is recognized again when it is renamed or plugged into another port.
+	char GUIDString[33];
+	SDL_JoystickGetGUIDString(SDL_JoystickGetGUID(Joystick), GUIDString, sizeof(GUIDString));
+	Descriptor.HardwareID = ANSI_TO_TCHAR(GUIDString);
+
+	//Start from the current state, so only changes become events.
+	if (!bOwnsSDL)
+	{
+		FRequencePolledJoystick& State = PolledJoysticks.Add(InstanceID);
+		for (int i = 0; i < Descriptor.NumAxises; i++) { State.Axises.Add(SDL_JoystickGetAxis(Joystick, i)); }
+		for (int i = 0; i < Descriptor.NumButtons; i++) { State.Buttons.Add(SDL_JoystickGetButton(Joystick, i)); }
+		for (int i = 0; i < Descriptor.NumHats; i++) { State.Hats.Add(SDL_JoystickGetHat(Joystick, i)); }
+	}
+	Queues.AddedDevices.Enqueue(Descriptor);
+}
+
+void FRequenceSDLInputSource::CloseDevice(int32 InstanceID, FRequenceInputQueues& Queues)
+{
+	SDL_Joystick* Joystick = nullptr;
+	if (Joysticks.RemoveAndCopyValue(InstanceID, Joystick) && Joystick != nullptr)
+	{
+		SDL_JoystickClose(Joystick);
+	}
+	PolledJoysticks.Remove(InstanceID);
+	Queues.RemovedDevices.Enqueue(InstanceID);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Synthetic
+//////////////////////////////////////////////////////////////////////////
+
+FRequenceSyntheticInputSource::FRequenceSyntheticInputSource(const FRequenceSyntheticInputConfig& InConfig)
+	: Config(InConfig), Random(InConfig.RandomSeed)
+{
+}
+
+bool FRequenceSyntheticInputSource::Init(FRequenceInputQueues& Queues)
+{
+	for (int32 i = 0; i < Config.NumDevices; i++)
+	{
+		FRequenceDeviceDescriptor Descriptor;
+		Descriptor.Which = i;
+		Descriptor.InstanceID = i;
+		Descriptor.Name = FString::Printf(TEXT("Synthetic%i"), i);
+		Descriptor.NumAxises = Config.NumAxises;
+		Descriptor.NumButtons = Config.NumButtons;
+		Descriptor.NumHats = Config.NumHats;
+		Queues.AddedDevices.Enqueue(Descriptor);
+	}
+
+	LastPumpTime = FPlatformTime::Seconds();
+	return true;
+}
+
+void FRequenceSyntheticInputSource::Pump(FRequenceInputQueues& Queues)
+{
+	double Now = FPlatformTime::Seconds();
+	GenerateEvents(Now - LastPumpTime, PumpBuffer);
+	LastPumpTime = Now;
+
+	const uint32 ReceiveCycles = FPlatformTime::Cycles();
+	for (FRequenceInputEvent& Event : PumpBuffer)
+	{
+		Event.ReceiveCycles = ReceiveCycles;
+		Queues.PushEvent(Event);
+	}
+	PumpBuffer.Reset();
+}
+
+void FRequenceSyntheticInputSource::GenerateEvents(double DeltaSeconds, TArray<FRequenceInputEvent>& OutEvents)
+{
+	const double TotalRate = Config.NumDevices * (Config.NumAxises * Config.AxisRate + Config.NumButtons * Config.ButtonRate + Config.NumHats * Config.HatRate);
+	EventBudget += DeltaSeconds * TotalRate;
+
+	int32 NumEvents = FMath::FloorToInt(EventBudget);
+	EventBudget -= NumEvents;
+	GenerateEvents(NumEvents, OutEvents);
+}
+
+void FRequenceSyntheticInputSource::GenerateEvents(int32 NumEvents, TArray<FRequenceInputEvent>& OutEvents)
+{
+	const float AxisWeight = Config.NumAxises * Config.AxisRate;
+	const float ButtonWeight = Config.NumButtons * Config.ButtonRate;
+	const float HatWeight = Config.NumHats * Config.HatRate;
+	const float TotalWeight = AxisWeight + ButtonWeight + HatWeight;
+	if (Config.NumDevices <= 0 || TotalWeight <= 0.f) { return; }
+
+	const double TimeStep = 1.0 / (Config.NumDevices * TotalWeight);
+	OutEvents.Reserve(OutEvents.Num() + NumEvents);
+
+	for (int32 i = 0; i < NumEvents; i++)
+	{
+		ElapsedTime += TimeStep;
+
+		if (Config.Script.Num() > 0)
+		{
+			OutEvents.Add(Config.Script[ScriptPosition]);
+			ScriptPosition = (ScriptPosition + 1) % Config.Script.Num();
+			continue;
+		}
+
+		//Pick a channel with a probability matching its rate.
+		int32 InstanceID = Random.RandRange(0, Config.NumDevices - 1);
+		float Pick = Random.FRand() * TotalWeight;
+		if (Pick < AxisWeight)
+		{
+			OutEvents.Add(MakeEvent(ERequenceInputEventType::Axis, InstanceID, Random.RandRange(0, Config.NumAxises - 1)));
+		}
+		else if (Pick < AxisWeight + ButtonWeight)
+		{
+			OutEvents.Add(MakeEvent(ERequenceInputEventType::Button, InstanceID, Random.RandRange(0, Config.NumButtons - 1)));
+		}
+		else
+		{
+			OutEvents.Add(MakeEvent(ERequenceInputEventType::Hat, InstanceID, Random.RandRange(0, Config.NumHats - 1)));
+		}
+	}
+}
+
+FRequenceInputEvent FRequenceSyntheticInputSource::MakeEvent(ERequenceInputEventType Type, int32 InstanceID, int32 Index)
+{
+	//Every valid hat mask, centered included.
+	static const uint8 HatMasks[] = { SDL_HAT_CENTERED, SDL_HAT_UP, SDL_HAT_RIGHTUP, SDL_HAT_RIGHT, SDL_HAT_RIGHTDOWN,
+									  SDL_HAT_DOWN, SDL_HAT_LEFTDOWN, SDL_HAT_LEFT, SDL_HAT_LEFTUP };
+
+	FRequenceInputEvent Event;
+	Event.Timestamp = (uint32)(ElapsedTime * 1000.0);
+	Event.InstanceID = InstanceID;
+	Event.Type = Type;
+	Event.Index = (uint8)Index;
+	GeneratedCount++;
+
+	switch (Type)
+	{
+		case ERequenceInputEventType::Axis:
+			Event.Value = Config.bRandomize
+				? (int16)Random.RandRange(-32768, 32767)
+				: (int16)(32767.f * FMath::Sin(ElapsedTime * PI + Index));
+			break;
+		case ERequenceInputEventType::Button:
+			Event.Value = Config.bRandomize ? (int16)Random.RandRange(0, 1) : (int16)((GeneratedCount >> 1) & 1);
+			break;
+		case ERequenceInputEventType::Hat:
+			Event.Value = Config.bRandomize
+				? HatMasks[Random.RandRange(0, ARRAY_COUNT(HatMasks) - 1)]
+				: HatMasks[GeneratedCount % ARRAY_COUNT(HatMasks)];
+			break;
+		default:
+			break;
+	}
+
+	return Event;
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceInputThread.h"
+#include "PlatformProcess.h"
+
+FRequenceInputThread::FRequenceInputThread(const TSharedRef<IRequenceInputSource>& InSource, FRequenceInputQueues& InQueues)
+	: Source(InSource), Queues(InQueues)
+{
+}
+
+FRequenceInputThread::~FRequenceInputThread()
+{
+	Shutdown();
+}
+
+bool FRequenceInputThread::Start()
+{
+	if (Thread != nullptr) { return true; }
+
+	StopRequested.Reset();
+	Thread = FRunnableThread::Create(this, TEXT("RequenceInputThread"), 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+void FRequenceInputThread::Shutdown()
+{
+	if (Thread == nullptr) { return; }
+
+	Thread->Kill(true);
+	delete Thread;
+	Thread = nullptr;
+}
+
+bool FRequenceInputThread::Init()
+{
+	return Source->Init(Queues);
+}
+
+uint32 FRequenceInputThread::Run()
+{
+	while (StopRequested.GetValue() == 0)
+	{
+		Source->Pump(Queues);
+		FPlatformProcess::Sleep(PollInterval);
+	}
+
+	return 0;
+}
+
+void FRequenceInputThread::Stop()
+{
+	StopRequested.Set(1);
+}
+
+void FRequenceInputThread::Exit()
+{
+	Source->Shutdown();
+}
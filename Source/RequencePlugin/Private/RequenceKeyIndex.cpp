@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceKeyIndex.h"
+#include "RequenceDevice.h"
+
+void FRequenceKeyIndex::Update(const TArray<URequenceDevice*>& Devices)
+{
+	//Same devices and no bindings changed anywhere, so every device is up to date.
+	const uint32 AllGeneration = URequenceDevice::GetAllBindingsGeneration();
+	if (AllGeneration == IndexedAllGeneration && Devices == IndexedDevices) { return; }
+
+	//Devices that are gone, or garbage collected.
+	if (IndexedGenerations.Num() > 0)
+	{
+		TSet<URequenceDevice*> LiveDevices;
+		LiveDevices.Reserve(Devices.Num());
+		LiveDevices.Append(Devices);
+
+		TArray<TWeakObjectPtr<URequenceDevice>, TInlineAllocator<8>> Removed;
+		for (const auto& Indexed : IndexedGenerations)
+		{
+			URequenceDevice* Device = Indexed.Key.Get();
+			if (Device == nullptr || !LiveDevices.Contains(Device)) { Removed.Add(Indexed.Key); }
+		}
+		for (const TWeakObjectPtr<URequenceDevice>& Device : Removed)
+		{
+			RemoveDevice(Device);
+		}
+	}
+
+	for (URequenceDevice* Device : Devices)
+	{
+		const uint32* Generation = IndexedGenerations.Find(Device);
+		if (Generation && *Generation == Device->GetBindingsGeneration()) { continue; }
+
+		if (Generation) { RemoveDevice(Device); }
+		AddDevice(Device);
+	}
+
+	IndexedDevices = Devices;
+	IndexedAllGeneration = AllGeneration;
+}
+
+void FRequenceKeyIndex::Reset()
+{
+	ByChord.Reset();
+	IndexedGenerations.Reset();
+	IndexedDevices.Reset();
+}
+
+void FRequenceKeyIndex::OnBindingMoved(URequenceDevice* Device, uint32 OldGeneration, uint32 NewGeneration, bool bIsAxis,
+	FName OldName, const FRequenceKeyChord& OldChord, FName NewName, const FRequenceKeyChord& NewChord)
+{
+	//Not indexed yet or already out of date, Update takes care of it.
+	uint32* Generation = IndexedGenerations.Find(Device);
+	if (Generation == nullptr || *Generation != OldGeneration) { return; }
+
+	if (OldChord.IsBound()) { Remove(OldChord, FRequenceKeyBinding(Device, OldName, bIsAxis)); }
+	if (NewChord.IsBound()) { Add(NewChord, FRequenceKeyBinding(Device, NewName, bIsAxis)); }
+	*Generation = NewGeneration;
+}
+
+TArrayView<const FRequenceKeyBinding> FRequenceKeyIndex::Find(const FRequenceKeyChord& Chord) const
+{
+	const FBindingList* Bindings = ByChord.Find(Chord);
+	if (Bindings == nullptr) { return TArrayView<const FRequenceKeyBinding>(); }
+	return TArrayView<const FRequenceKeyBinding>(Bindings->GetData(), Bindings->Num());
+}
+
+void FRequenceKeyIndex::AddDevice(URequenceDevice* Device)
+{
+	for (const FRequenceInputAction& ac : Device->Actions)
+	{
+		const FRequenceKeyChord Chord(ac);
+		if (Chord.IsBound()) { Add(Chord, FRequenceKeyBinding(Device, ac.ActionName, false)); }
+	}
+	for (const FRequenceInputAxis& ax : Device->Axises)
+	{
+		const FRequenceKeyChord Chord(ax);
+		if (Chord.IsBound()) { Add(Chord, FRequenceKeyBinding(Device, ax.AxisName, true)); }
+	}
+	IndexedGenerations.Add(Device, Device->GetBindingsGeneration());
+}
+
+void FRequenceKeyIndex::RemoveDevice(const TWeakObjectPtr<URequenceDevice>& Device)
+{
+	//Only on bulk changes, so a full pass is fine.
+	for (auto It = ByChord.CreateIterator(); It; ++It)
+	{
+		It.Value().RemoveAll([&Device](const FRequenceKeyBinding& Binding) { return Binding.Device == Device; });
+		if (It.Value().Num() == 0) { It.RemoveCurrent(); }
+	}
+	IndexedGenerations.Remove(Device);
+}
+
+void FRequenceKeyIndex::Add(const FRequenceKeyChord& Chord, const FRequenceKeyBinding& Binding)
+{
+	ByChord.FindOrAdd(Chord).Add(Binding);
+}
+
+void FRequenceKeyIndex::Remove(const FRequenceKeyChord& Chord, const FRequenceKeyBinding& Binding)
+{
+	FBindingList* Bindings = ByChord.Find(Chord);
+	if (Bindings == nullptr) { return; }
+
+	Bindings->RemoveSingle(Binding);
+	if (Bindings->Num() == 0) { ByChord.Remove(Chord); }
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceKeyTypes.h"
+#include "RequenceDevice.h"
+
+ERequenceDeviceType FRequenceKeyTypes::Get(const FKey& Key)
+{
+	TMap<FKey, ERequenceDeviceType>& Table = GetTable();
+	if (const ERequenceDeviceType* Type = Table.Find(Key)) { return *Type; }
+	return Table.Add(Key, Classify(Key));
+}
+
+void FRequenceKeyTypes::RegisterUniqueDeviceKey(const FKey& Key)
+{
+	GetTable().Add(Key, ERequenceDeviceType::RDT_Unique);
+}
+
+TMap<FKey, ERequenceDeviceType>& FRequenceKeyTypes::GetTable()
+{
+	static TMap<FKey, ERequenceDeviceType> Table;
+	if (Table.Num() == 0)
+	{
+		TArray<FKey> AllKeys;
+		EKeys::GetAllKeys(AllKeys);
+		Table.Reserve(AllKeys.Num());
+		for (const FKey& Key : AllKeys)
+		{
+			Table.Add(Key, Classify(Key));
+		}
+	}
+	return Table;
+}
+
+const TSet<FKey>& FRequenceKeyTypes::GetMotionControllerKeys()
+{
+	static TSet<FKey> Keys;
+	if (Keys.Num() == 0)
+	{
+		const FKey MotionControllerKeys[] =
+		{
+			//Left Controller
+			EKeys::MotionController_Left_FaceButton1, EKeys::MotionController_Left_FaceButton2, EKeys::MotionController_Left_FaceButton3,
+			EKeys::MotionController_Left_FaceButton4, EKeys::MotionController_Left_FaceButton5, EKeys::MotionController_Left_FaceButton6,
+			EKeys::MotionController_Left_FaceButton7, EKeys::MotionController_Left_FaceButton8,
+			EKeys::MotionController_Left_Shoulder, EKeys::MotionController_Left_Trigger,
+			EKeys::MotionController_Left_Grip1, EKeys::MotionController_Left_Grip2,
+			EKeys::MotionController_Left_Thumbstick,
+			EKeys::MotionController_Left_Thumbstick_Up, EKeys::MotionController_Left_Thumbstick_Down,
+			EKeys::MotionController_Left_Thumbstick_Left, EKeys::MotionController_Left_Thumbstick_Right,
+			EKeys::MotionController_Left_Thumbstick_X, EKeys::MotionController_Left_Thumbstick_Y,
+			EKeys::MotionController_Left_TriggerAxis, EKeys::MotionController_Left_Grip1Axis, EKeys::MotionController_Left_Grip2Axis,
+
+			//Right Controller
+			EKeys::MotionController_Right_FaceButton1, EKeys::MotionController_Right_FaceButton2, EKeys::MotionController_Right_FaceButton3,
+			EKeys::MotionController_Right_FaceButton4, EKeys::MotionController_Right_FaceButton5, EKeys::MotionController_Right_FaceButton6,
+			EKeys::MotionController_Right_FaceButton7, EKeys::MotionController_Right_FaceButton8,
+			EKeys::MotionController_Right_Shoulder, EKeys::MotionController_Right_Trigger,
+			EKeys::MotionController_Right_Grip1, EKeys::MotionController_Right_Grip2,
+			EKeys::MotionController_Right_Thumbstick,
+			EKeys::MotionController_Right_Thumbstick_Up, EKeys::MotionController_Right_Thumbstick_Down,
+			EKeys::MotionController_Right_Thumbstick_Left, EKeys::MotionController_Right_Thumbstick_Right,
+			EKeys::MotionController_Right_Thumbstick_X, EKeys::MotionController_Right_Thumbstick_Y,
+			EKeys::MotionController_Right_TriggerAxis, EKeys::MotionController_Right_Grip1Axis, EKeys::MotionController_Right_Grip2Axis
+		};
+		Keys.Append(MotionControllerKeys, ARRAY_COUNT(MotionControllerKeys));
+	}
+	return Keys;
+}
+
+ERequenceDeviceType FRequenceKeyTypes::Classify(const FKey& Key)
+{
+	if (GetMotionControllerKeys().Contains(Key)) { return ERequenceDeviceType::RDT_MotionController; }
+
+	//Not registered with the engine, eg. a unique device that is not connected or a key of a plugin that is not loaded.
+	if (!EKeys::GetKeyDetails(Key).IsValid())
+	{
+		return URequenceDevice::GetDeviceTypeByKeyString(Key.ToString());
+	}
+
+	//Mouse axises carry the mouse button flag as well.
+	if (Key.IsMouseButton()) { return ERequenceDeviceType::RDT_Mouse; }
+
+	if (Key.IsGamepadKey())
+	{
+		//Plugins register their motion controllers (eg. Oculus Touch) and USB controllers as gamepad keys too.
+		//The engine has no flag for those, so only they are still told apart by name.
+		const ERequenceDeviceType ByName = URequenceDevice::GetDeviceTypeByKeyString(Key.ToString());
+		if (ByName == ERequenceDeviceType::RDT_MotionController || ByName == ERequenceDeviceType::RDT_Unique) { return ByName; }
+		return ERequenceDeviceType::RDT_Gamepad;
+	}
+
+	return ERequenceDeviceType::RDT_Keyboard;
+}
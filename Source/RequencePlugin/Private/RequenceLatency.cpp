@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceLatency.h"
+
+void FRequenceLatencyHistogram::Tick(double Now)
+{
+	if (WindowStart < 0.0)
+	{
+		WindowStart = Now;
+		return;
+	}
+	if (Now - WindowStart < WindowSeconds) { return; }
+
+	Current ^= 1;
+	FMemory::Memzero(Buckets[Current], sizeof(Buckets[Current]));
+	NumSamples[Current] = 0;
+	MaxSample[Current] = 0;
+	WindowStart = Now;
+}
+
+void FRequenceLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets, sizeof(Buckets));
+	NumSamples[0] = NumSamples[1] = 0;
+	MaxSample[0] = MaxSample[1] = 0;
+	Current = 0;
+	WindowStart = -1.0;
+}
+
+uint32 FRequenceLatencyHistogram::GetPercentile(float Percentile) const
+{
+	const int32 Total = GetNumSamples();
+	if (Total == 0) { return 0; }
+
+	//Rank of the sample we're looking for, 1 based.
+	const int32 Rank = FMath::Clamp(FMath::CeilToInt(Percentile * Total), 1, Total);
+	int32 Seen = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		Seen += Buckets[0][Bucket] + Buckets[1][Bucket];
+		if (Seen >= Rank)
+		{
+			//Never report more than was actually measured.
+			return FMath::Min(GetBucketUpperBound(Bucket), GetMax());
+		}
+	}
+	return GetMax();
+}
+
+FRequenceLatencyPercentiles FRequenceLatencyHistogram::GetPercentiles() const
+{
+	FRequenceLatencyPercentiles Result;
+	Result.NumSamples = GetNumSamples();
+	Result.P50 = GetPercentile(0.5f) / 1000.f;
+	Result.P90 = GetPercentile(0.9f) / 1000.f;
+	Result.P99 = GetPercentile(0.99f) / 1000.f;
+	Result.Max = GetMax() / 1000.f;
+	return Result;
+}
+
+int32 FRequenceLatencyHistogram::GetBucket(uint32 Microseconds)
+{
+	//0-3 get a bucket each, then 4 buckets per power of two picked by the 2 bits below the highest.
+	if (Microseconds < 4) { return Microseconds; }
+
+	const uint32 Log2 = FMath::FloorLog2(Microseconds);
+	const int32 Bucket = 4 * (Log2 - 1) + ((Microseconds >> (Log2 - 2)) & 3);
+	return FMath::Min(Bucket, NumBuckets - 1);
+}
+
+uint32 FRequenceLatencyHistogram::GetBucketUpperBound(int32 Bucket)
+{
+	if (Bucket < 4) { return Bucket + 1; }
+
+	const uint32 Log2 = Bucket / 4 + 1;
+	const uint64 Lower = (uint64)(4 + Bucket % 4) << (Log2 - 2);
+	return (uint32)FMath::Min<uint64>(Lower + (1ull << (Log2 - 2)), MAX_uint32);
+}
@@ -34,7 +34,6 @@ void FRequencePluginModule::StartupModule()
 #else
 	LibraryPath = FPaths::Combine(*BaseDir, TEXT("Binaries/ThirdParty/Win64/SDL2.dll"));
 	UE_LOG(LogRequence, Log, TEXT("Loading 64-bit SDL at %s"), *LibraryPath);
-#endif
 #endif
 
 	SDLLibrary = !LibraryPath.IsEmpty() ? FPlatformProcess::GetDllHandle(*LibraryPath) : nullptr;
@@ -43,6 +42,7 @@ void FRequencePluginModule::StartupModule()
 	{
 		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("Requence", "Failed to load SDL. Is the DLL available for your OS/Architecture?"));
 	} 
+#endif
 
 	IModularFeatures::Get().RegisterModularFeature(IInputDeviceModule::GetModularFeatureName(), this);
 	//InputDevice = MakeShareable(new RequenceInputDevice());
@@ -52,8 +52,11 @@ void FRequencePluginModule::StartupModule()
 
 void FRequencePluginModule::ShutdownModule()
 {
-	FPlatformProcess::FreeDllHandle(SDLLibrary);
-	SDLLibrary = nullptr;
+	if (SDLLibrary)
+	{
+		FPlatformProcess::FreeDllHandle(SDLLibrary);
+		SDLLibrary = nullptr;
+	}
 
 	IModularFeatures::Get().UnregisterModularFeature(IInputDeviceModule::GetModularFeatureName(), this);
 
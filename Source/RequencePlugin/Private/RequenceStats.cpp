@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequenceStats.h"
+
+DEFINE_STAT(STAT_Requence_HandleSDLEvent);
+
+DEFINE_STAT(STAT_Requence_SendControllerEvents);
+DEFINE_STAT(STAT_Requence_HandleInputHat);
+DEFINE_STAT(STAT_Requence_HandleInputButton);
+DEFINE_STAT(STAT_Requence_HandleInputAxis);
+DEFINE_STAT(STAT_Requence_FlushCoalescedAxises);
+DEFINE_STAT(STAT_Requence_AddDevice);
+
+DEFINE_STAT(STAT_Requence_ApplyAxisesAndActions);
+DEFINE_STAT(STAT_Requence_LoadInput);
+DEFINE_STAT(STAT_Requence_SaveInput);
+DEFINE_STAT(STAT_Requence_InputDevicesUpdated);
+
+DEFINE_STAT(STAT_Requence_NumEvents);
+DEFINE_STAT(STAT_Requence_NumAxisDispatches);
+DEFINE_STAT(STAT_Requence_NumCoalescedAxises);
+DEFINE_STAT(STAT_Requence_EventQueueDepth);
+
+DEFINE_STAT(STAT_Requence_NumDroppedEvents);
+DEFINE_STAT(STAT_Requence_NumDevices);
@@ -6,7 +6,7 @@ URequenceStructs::URequenceStructs()
 {
 }
 
-float URequenceStructs::Interpolate(TArray<FVector2D> Points, float val)
+float URequenceStructs::Interpolate(const TArray<FVector2D>& Points, float val)
 {
 	for (int i = 1; i < Points.Num(); i++)	//Note, skips first
 	{
@@ -18,3 +18,80 @@ float URequenceStructs::Interpolate(TArray<FVector2D> Points, float val)
 
 	return val;
 }
+
+FRequenceBakedCurve::FRequenceBakedCurve(const TArray<FVector2D>& InPoints) : Points(InPoints)
+{
+	const float CellSize = 2.f / Resolution;
+	Values.SetNumUninitialized(Resolution + 1);
+	Slopes.SetNumUninitialized(Resolution);
+
+	for (int32 i = 0; i <= Resolution; i++)
+	{
+		Values[i] = EvaluateExact(-1.f + i * CellSize);
+	}
+	for (int32 i = 0; i < Resolution; i++)
+	{
+		Slopes[i] = (Values[i + 1] - Values[i]) / CellSize;
+	}
+
+	//Cells without a data point inside are exact, up to float rounding.
+	float MaxSlope = 0.f;
+	for (int32 i = 1; i < Points.Num(); i++)
+	{
+		const float Width = Points[i].X - Points[i - 1].X;
+		if (Width > 0.f) { MaxSlope = FMath::Max(MaxSlope, FMath::Abs((Points[i].Y - Points[i - 1].Y) / Width)); }
+	}
+	Tolerance = CellSize * MaxSlope * 0.5f + KINDA_SMALL_NUMBER;
+}
+
+float FRequenceBakedCurve::Evaluate(float Value) const
+{
+	const float CellSize = 2.f / Resolution;
+	const float Clamped = FMath::Clamp(Value, -1.f, 1.f);
+	const int32 Cell = FMath::Clamp(FMath::FloorToInt((Clamped + 1.f) / CellSize), 0, Resolution - 1);
+	return Values[Cell] + (Clamped - (-1.f + Cell * CellSize)) * Slopes[Cell];
+}
+
+float FRequenceBakedCurve::EvaluateExact(float Value) const
+{
+	return URequenceStructs::Interpolate(Points, Value);
+}
+
+float FRequencePhysicalAxis::ApplyDeadZone(float Value, float DeadZone)
+{
+	if (DeadZone <= 0.f) { return Value; }
+	if (DeadZone >= 1.f) { return 0.f; }
+
+	const float Magnitude = FMath::Abs(Value);
+	if (Magnitude <= DeadZone) { return 0.f; }
+	return FMath::Sign(Value) * (Magnitude - DeadZone) / (1.f - DeadZone);
+}
+
+void FRequencePhysicalAxis::BakeCurve()
+{
+	BakedCurve.Reset();
+	if (!bIsPrecached || DataPoints.Num() <= 0) { return; }
+
+	BakedCurve = MakeShareable(new FRequenceBakedCurve(DataPoints));
+}
+
+float FRequencePhysicalAxis::EvaluateBaked(float Value) const
+{
+	return BakedCurve.IsValid() ? BakedCurve->Evaluate(Value) : EvaluateExact(Value);
+}
+
+float FRequencePhysicalAxis::EvaluateExact(float Value) const
+{
+	return URequenceStructs::Interpolate(DataPoints, Value);
+}
+
+float FRequencePhysicalAxis::MeasureBakedCurveError(int32 NumSamples) const
+{
+	float MaxError = 0.f;
+	for (int32 i = 0; i <= NumSamples; i++)
+	{
+		const float Value = -1.f + 2.f * i / NumSamples;
+		MaxError = FMath::Max(MaxError, FMath::Abs(EvaluateBaked(Value) - EvaluateExact(Value)));
+	}
+	return MaxError;
+}
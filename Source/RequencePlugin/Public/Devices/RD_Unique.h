@@ -15,6 +15,8 @@ class REQUENCEPLUGIN_API URD_Unique : public URequenceDevice
 	
 public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	bool bHasPhysicalData = false;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	FString HardwareID;		//SDL joystick GUID, the same for every unit of a model. Set through FRequenceDeviceRegistry::SetIdentity.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	int32 HardwareOrdinal = 0;	//Which unit of the model, by SDL device index among the connected ones. Set with HardwareID.
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	TArray<FString> PhysicalButtons;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	TArray<FRequencePhysicalAxis> PhysicalAxises;
 
@@ -22,19 +24,22 @@ public:
 	// Physical Axis configuration
 	//////////////////////////////////////////////////////////////////////////
 
-	void LoadDefaultPhysicalData(FSDLDeviceInfo Data);
+	void LoadDefaultPhysicalData(const FSDLDeviceInfo& Data);
+
+	//Finds a physical axis without copying it. nullptr when there is none.
+	const FRequencePhysicalAxis* FindPhysicalAxis(const FString& PhysicalAxisName) const;
 
 	//Retreives a copy of a physical axis struct.
-	UFUNCTION(BlueprintCallable)	FRequencePhysicalAxis GetPhysicalAxisByName(FString PhysicalAxisName);
+	UFUNCTION(BlueprintCallable)	FRequencePhysicalAxis GetPhysicalAxisByName(const FString& PhysicalAxisName);
 
 	//Retrieves a copy of a physical axis struct, by its compactified name.
-	UFUNCTION(BlueprintCallable)	FRequencePhysicalAxis GetPhysicalAxisByCompactifiedName(FString CompressedAxisName);
+	UFUNCTION(BlueprintCallable)	FRequencePhysicalAxis GetPhysicalAxisByCompactifiedName(const FString& CompressedAxisName);
 
 	//Updates a physical axis struct. AxisNames must match.
-	UFUNCTION(BlueprintCallable)	bool UpdatePhysicalAxisDataPoints(FString AxisName, TArray<FVector2D> DataPoints);
+	UFUNCTION(BlueprintCallable)	bool UpdatePhysicalAxisDataPoints(const FString& AxisName, const TArray<FVector2D>& DataPoints);
 
 	//Updates a physical axis struct. AxisNames must match.
-	UFUNCTION(BlueprintCallable)	bool UpdatePhysicalAxis(FRequencePhysicalAxis toUpdate);
+	UFUNCTION(BlueprintCallable)	bool UpdatePhysicalAxis(const FRequencePhysicalAxis& toUpdate);
 
 
 	//////////////////////////////////////////////////////////////////////////
@@ -44,10 +49,13 @@ public:
 	//Retrieves this class' data as a JSON object.
 	virtual TSharedPtr<FJsonObject> GetDeviceAsJson() override;
 
+	//Replaces the physical axises with the PhysicalAxises block of a preset, see GetDeviceAsJson.
+	void SetJsonAsPhysicalAxises(const TArray<TSharedPtr<FJsonValue>>& _PhysicalAxises);
+
 	//Creates a save object device from this device.
-	virtual FRequenceSaveObjectDevice ToStruct() override;
+	virtual FRequenceSaveObjectDevice ToStruct() const override;
 
-	//Fills this device from a requence save object device.
-	virtual void FromStruct(FRequenceSaveObjectDevice StructIn, URequence* _RequenceRef,
-		TArray<FString> FullAxisList, TArray<FString> FullActionList) override;
+	//Fills this device from a requence save object device. Takes over its arrays, StructIn is left empty.
+	virtual void FromStruct(FRequenceSaveObjectDevice&& StructIn, URequence* _RequenceRef,
+		const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList) override;
 };
@@ -6,6 +6,8 @@
 #include "RequenceStructs.h"
 #include "RequenceDevice.h"
 #include "RequenceSaveObject.h"
+#include "RequenceBindingTable.h"
+#include "RequenceDeviceRegistry.h"
 #include "Paths.h"
 #include "Requence.generated.h"
 
@@ -13,6 +15,8 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRequenceOnEditModeStarted, ERequenc
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRequenceOnEditModeEnded);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRequenceUpdatedUniqueDevices);
 
+class RequenceInputDevice;
+
 /*
 *  Danny de Bruijne (2018)
 *  Requence
@@ -45,10 +49,10 @@ private:
 	UPROPERTY()						TArray<URequenceDevice*>	Devices;
 public:
 	//Full Axis list - Used to make sure all devices have every axis
-	UPROPERTY()						TArray<FString> FullAxisList;
+	UPROPERTY()						TArray<FName> FullAxisList;
 
 	//Full Action list - Used to make sure all devices have every action
-	UPROPERTY()						TArray<FString> FullActionList;
+	UPROPERTY()						TArray<FName> FullActionList;
 
 	//Whether edit mode is enabled - This can be used in blueprint to track if one entry is being edited.
 	UPROPERTY()						bool bEditModeEnabled = false;
@@ -105,7 +109,7 @@ public:
 	UFUNCTION(BlueprintCallable)	void ExportDeviceAsPreset(URequenceDevice* Device);	
 	
 	// Imports a JSON file and creates a device. returns false if failed.
-	UFUNCTION(BlueprintCallable)	bool ImportDeviceAsPreset(FString AbsolutePath);
+	UFUNCTION(BlueprintCallable)	bool ImportDeviceAsPreset(const FString& AbsolutePath);
 
 	//Returns a list of filenames that can be imported (in the default folder). Empty if failed.
 	UFUNCTION(BlueprintCallable)	TArray<FString> GetImportableDevicePresets();	
@@ -119,17 +123,26 @@ public:
 	UFUNCTION()						bool FillFullAxisActionLists();
 
 	//Tries to find a device by its DeviceString. Returns a nullptr when failed.
- 	UFUNCTION(BlueprintCallable)	URequenceDevice* GetDeviceByString(FString DeviceString);
+ 	UFUNCTION(BlueprintCallable)	URequenceDevice* GetDeviceByString(const FString& DeviceString);
 
 	//Tries to find a device by its ERequenceDeviceType. Returns a nullptr when failed.
  	UFUNCTION(BlueprintCallable)	URequenceDevice* GetDeviceByType(ERequenceDeviceType DeviceType);
 
 	//Tries to create a device by a key name. Returns a nullptr when failed.
-	UFUNCTION()						URequenceDevice* CreateDevice(FString KeyName);
+	UFUNCTION()						URequenceDevice* CreateDevice(const FString& KeyName);
+
+	//Tries to create a device of a type. Returns a nullptr when failed, or when there already is one.
+	URequenceDevice* CreateDeviceByType(ERequenceDeviceType DeviceType);
+
+	//All devices, without copying the array.
+	TArrayView<URequenceDevice* const> GetDevices() const { return TArrayView<URequenceDevice* const>(Devices); }
 
 	//Returns all unique devices in the Devices array.
 	UFUNCTION(BlueprintCallable)	TArray<URequenceDevice*> GetUniqueDevices();
 
+	//All unique devices, without copying. Valid until devices are added or removed.
+	TArrayView<URequenceDevice* const> GetUniqueDevicesView() const { return DeviceRegistry.GetDevicesOfType(ERequenceDeviceType::RDT_Unique); }
+
 	//Prints all found axises and actions.
 	UFUNCTION(BlueprintCallable)	void DebugPrint(bool UseDevices);
 
@@ -151,6 +164,72 @@ public:
 	//Ends edit mode.
 	UFUNCTION(BlueprintCallable)	void SetEditModeEnded();
 
+	//Returns rolling input latency percentiles of every connected unique device.
+	UFUNCTION(BlueprintCallable)	TArray<FRequenceDeviceLatency> GetInputLatency();
+
+	//Call from an action or axis event bound to a unique device key, to include the game's own delay in GetInputLatency.
+	UFUNCTION(BlueprintCallable)	void ReportInputConsumed(const FKey& Key);
+
 	//Returns the requence version number.
 	UFUNCTION(BlueprintCallable)	int GetVersion() { return Version; }
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Conflicts
+	//////////////////////////////////////////////////////////////////////////
+
+	//Whether any action or axis other than IgnoreName is bound to this key and modifiers. Cheap enough to call every frame.
+	UFUNCTION(BlueprintCallable)	bool HasBindingConflict(const FKey& Key, bool bShift, bool bCtrl, bool bAlt, bool bCmd, FName IgnoreName);
+
+	//Every action and axis bound to this key and modifiers, on any device. Returns whether there are any.
+	UFUNCTION(BlueprintCallable)	bool GetBindingConflicts(const FKey& Key, bool bShift, bool bCtrl, bool bAlt, bool bCmd, TArray<FRequenceBindingConflict>& OutConflicts);
+
+	//Every binding on a chord, without copying. Valid until bindings change.
+	TArrayView<const FRequenceKeyBinding> FindBindingsByKey(const FRequenceKeyChord& Chord);
+
+	//Reverse key index over all devices. Devices report their changes here.
+	FRequenceKeyIndex& GetKeyIndex() { return KeyIndex; }
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Binding queries
+	//////////////////////////////////////////////////////////////////////////
+
+	//Keys bound to an action or axis on a device, in binding order. Returns whether there are any.
+	UFUNCTION(BlueprintCallable)	bool GetBoundKeys(URequenceDevice* Device, FName Name, bool bIsAxis, TArray<FKey>& OutKeys);
+
+	//First key bound to an action or axis on a device, for prompts. An invalid key when unbound.
+	UFUNCTION(BlueprintCallable)	FKey GetFirstBoundKey(URequenceDevice* Device, FName Name, bool bIsAxis);
+
+	//Compiled bindings of all devices, recompiled first when any device changed since.
+	const FRequenceBindingTable& GetBindingTable();
+
+	//Engine key mappings of all devices together, as applied and written to Input.ini. Rebuilt when any device changed since.
+	const FRequenceEngineMappings& GetEngineMappings();
+
+private:
+	//What every device put in the engine mappings at the last apply, so the next one only patches what changed.
+	TMap<TWeakObjectPtr<URequenceDevice>, TSharedPtr<const FRequenceEngineMappings>> AppliedMappings;
+
+	//Whether UInputSettings holds exactly AppliedMappings.
+	bool bHasAppliedMappings = false;
+
+	//Devices by type, DeviceString and hardware identity. Every change to Devices goes through it as well.
+	FRequenceDeviceRegistry DeviceRegistry;
+
+	//See GetKeyIndex.
+	FRequenceKeyIndex KeyIndex;
+
+	//See GetBindingTable.
+	FRequenceBindingTable BindingTable;
+
+	//See GetEngineMappings. EngineMappingSources holds the device mappings it was built from.
+	FRequenceEngineMappings EngineMappings;
+	TArray<TSharedRef<const FRequenceEngineMappings>> EngineMappingSources;
+
+	//Rebuilds the engine mappings from every device and has all players rebuild their key maps.
+	void ApplyAllMappings(UInputSettings& Settings, RequenceInputDevice* InputDevice);
+
+	//Patches the engine mappings and live players with the bindings that changed since the last apply. Returns whether anything changed.
+	bool ApplyChangedMappings(UInputSettings& Settings, RequenceInputDevice* InputDevice);
 };
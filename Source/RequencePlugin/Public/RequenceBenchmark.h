@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Result of one benchmark case.
+struct FRequenceBenchmarkResult
+{
+	FString Name;
+	int64 NumEvents = 0;
+	double Seconds = 0.0;
+	int64 NumAllocations = 0;
+
+	double GetEventsPerSecond() const { return Seconds > 0.0 ? NumEvents / Seconds : 0.0; }
+	double GetNanosecondsPerEvent() const { return NumEvents > 0 ? Seconds * 1e9 / NumEvents : 0.0; }
+};
+
+/*
+*  FRequenceScopedAllocationCounter
+*
+*  Counts heap allocations made by the constructing thread while in scope, by routing GMalloc through a counting proxy.
+*  Not reentrant, only one counter can be alive at a time.
+*/
+class REQUENCEPLUGIN_API FRequenceScopedAllocationCounter
+{
+public:
+	FRequenceScopedAllocationCounter();
+	~FRequenceScopedAllocationCounter();
+
+	int64 GetCount() const;
+};
+
+/*
+*  FRequenceBenchmark
+*
+*  Microbenchmarks for the Requence input path. Runs on synthetic input, needs no devices and no Slate.
+*/
+class REQUENCEPLUGIN_API FRequenceBenchmark
+{
+public:
+	//Default amount of events per benchmark case.
+	static const int32 DefaultNumEvents = 200000;
+
+	//Times HandleInput_Axis, HandleInput_Button and HandleInput_Hat over NumEvents synthetic events each.
+	static TArray<FRequenceBenchmarkResult> RunInputBenchmark(int32 NumEvents = DefaultNumEvents);
+
+	//Default synthetic binding setup, per device.
+	static const int32 DefaultNumDevices = 4;
+	static const int32 DefaultNumBindings = 64;
+
+	//Times loading, applying and saving the bindings of NumDevices devices with NumBindings actions and NumBindings axises each.
+	static TArray<FRequenceBenchmarkResult> RunBindingBenchmark(int32 NumDevices = DefaultNumDevices, int32 NumBindings = DefaultNumBindings);
+
+	//Runs RunBindingBenchmark with NumBindings and twice that, and checks that loading, applying and saving allocate per device,
+	//not per binding. Returns whether the check passed.
+	static bool CheckBindingAllocations(int32 NumDevices, int32 NumBindings, TArray<FRequenceBenchmarkResult>& OutResults, FOutputDevice& Ar);
+
+	//Times replaying a recording through a fresh device, see FRequenceInputRecorder.
+	static FRequenceBenchmarkResult RunReplayBenchmark(const FString& Filename);
+
+	//Writes results as a table.
+	static void PrintResults(const TArray<FRequenceBenchmarkResult>& Results, FOutputDevice& Ar);
+};
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RequenceBenchmarkCommandlet.generated.h"
+
+/*
+*  URequenceBenchmarkCommandlet
+*
+*  Runs FRequenceBenchmark headless on synthetic input and bindings. Fails when applying or saving bindings allocates per binding.
+*  Usage: UE4Editor-Cmd <Project> -run=RequenceBenchmark [-Events=N] [-Devices=N] [-Bindings=N] [-Replay=<Recording>]
+*/
+UCLASS()
+class REQUENCEPLUGIN_API URequenceBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URequenceBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArrayView.h"
+#include "InputCoreTypes.h"
+
+class URequenceDevice;
+
+//One bound action or axis slot, compiled. Plain data only, resolve the IDs through FRequenceBindingTable.
+struct FRequenceCompiledBinding
+{
+	int32 NameID;		//FRequenceBindingTable::GetName
+	int32 KeyID;		//FRequenceBindingTable::GetKey
+	int32 DeviceID;		//FRequenceBindingTable::GetDevice
+	uint8 Modifiers;	//FRequenceKeyChord::EModifier
+	uint8 bIsAxis;
+	float Scale;		//1 for actions
+};
+
+/*
+*  FRequenceBindingTable
+*
+*  Immutable snapshot of the bound actions and axises of all devices, for fast runtime queries such as on-screen prompts.
+*  Bindings are stored contiguously, grouped by device, name and kind, so one lookup gives every key of an action on a device.
+*  Name, key and device IDs are per compile, a cached ID is only valid while GetGeneration is unchanged.
+*/
+class REQUENCEPLUGIN_API FRequenceBindingTable
+{
+public:
+	//Whether the table still matches these devices and their generations.
+	bool IsUpToDate(const TArray<URequenceDevice*>& InDevices) const;
+
+	//Rebuilds the table from the current bindings of these devices.
+	void Compile(const TArray<URequenceDevice*>& InDevices);
+
+	//Changes with every compile.
+	uint32 GetGeneration() const { return Generation; }
+
+	//INDEX_NONE when the name, key or device is not in the table.
+	int32 FindNameID(FName Name) const;
+	int32 FindKeyID(const FKey& Key) const;
+	int32 FindDeviceID(const URequenceDevice* Device) const;
+
+	FName GetName(int32 NameID) const { return Names[NameID]; }
+	const FKey& GetKey(int32 KeyID) const { return Keys[KeyID]; }
+	URequenceDevice* GetDevice(int32 DeviceID) const { return Devices[DeviceID].Get(); }
+
+	//Every binding of one action or axis on one device, in binding order.
+	TArrayView<const FRequenceCompiledBinding> Find(int32 DeviceID, int32 NameID, bool bIsAxis) const;
+
+	TArrayView<const FRequenceCompiledBinding> GetBindings() const { return TArrayView<const FRequenceCompiledBinding>(Bindings); }
+
+private:
+	TArray<FRequenceCompiledBinding> Bindings;
+
+	//First binding of every (device, name, kind) cell, see GetCell. One extra entry at the end, so a cell ends where the next one starts.
+	TArray<int32> CellStarts;
+
+	//Names and keys of the bound bindings as compiled, so the cells only span names in use.
+	TArray<FName> Names;
+	TMap<FName, int32> NameIDs;
+	TArray<FKey> Keys;
+	TMap<FKey, int32> KeyIDs;
+
+	//Devices and their generation as compiled.
+	TArray<TWeakObjectPtr<URequenceDevice>> Devices;
+	TArray<uint32> DeviceGenerations;
+	TMap<const URequenceDevice*, int32> DeviceIDs;
+
+	uint32 Generation = 0;
+
+	int32 GetCell(int32 DeviceID, int32 NameID, bool bIsAxis) const { return (DeviceID * Names.Num() + NameID) * 2 + (bIsAxis ? 1 : 0); }
+	int32 AddName(FName Name);
+	int32 AddKey(const FKey& Key);
+};
@@ -6,11 +6,184 @@
 #include "UObject/NoExportTypes.h"
 #include "RequenceStructs.h"
 #include "RequenceSaveObject.h"
+#include "RequenceKeyIndex.h"
 #include "JsonValue.h"
 #include "RequenceDevice.generated.h"
 
 class URequence;
 
+FORCEINLINE FName GetBindingName(const FRequenceInputAction& Action) { return Action.ActionName; }
+FORCEINLINE FName GetBindingName(const FRequenceInputAxis& Axis) { return Axis.AxisName; }
+FORCEINLINE bool IsBindingBound(const FKey& Key) { return Key != FKey(); }
+
+//Hashable (action/axis name, key) pair.
+struct FRequenceBindingKey
+{
+	FName Name;
+	FKey Key;
+
+	FRequenceBindingKey(const FName InName, const FKey& InKey) : Name(InName), Key(InKey) {}
+
+	bool operator==(const FRequenceBindingKey& Other) const { return Key == Other.Key && Name == Other.Name; }
+	friend uint32 GetTypeHash(const FRequenceBindingKey& BindingKey) { return HashCombine(GetTypeHash(BindingKey.Name), GetTypeHash(BindingKey.Key)); }
+};
+
+//Every slot with one action/axis name, ascending.
+struct FRequenceBindingSlots
+{
+	TArray<int32, TInlineAllocator<4>> Slots;
+	int32 NumBound = 0;
+};
+
+/*
+*  TRequenceBindingIndex
+*
+*  Hash indices over an array of FRequenceInputAction or FRequenceInputAxis: name to slots, and bound (name, key) to slot.
+*  Follows appends and key changes, anything else should MarkDirty so the next Update rebuilds it.
+*/
+template<typename BindingType>
+class TRequenceBindingIndex
+{
+public:
+	void MarkDirty() { bDirty = true; }
+
+	void Update(const TArray<BindingType>& Bindings)
+	{
+		if (!bDirty) { return; }
+
+		ByName.Reset();
+		ByBinding.Reset();
+		for (int32 Slot = 0; Slot < Bindings.Num(); Slot++)
+		{
+			Add(Bindings, Slot);
+		}
+		bDirty = false;
+	}
+
+	//Call after inserting Bindings[Slot]. Slot must come after every other binding with the same name.
+	void OnInserted(const TArray<BindingType>& Bindings, int32 Slot)
+	{
+		if (bDirty) { return; }
+
+		for (auto& Entry : ByName)
+		{
+			for (int32& Other : Entry.Value.Slots)
+			{
+				if (Other >= Slot) { Other++; }
+			}
+		}
+		for (auto& Entry : ByBinding)
+		{
+			if (Entry.Value >= Slot) { Entry.Value++; }
+		}
+		Add(Bindings, Slot);
+	}
+
+	//Call after appending Bindings[Slot].
+	void Add(const TArray<BindingType>& Bindings, int32 Slot)
+	{
+		const BindingType& Binding = Bindings[Slot];
+		FRequenceBindingSlots& Entry = ByName.FindOrAdd(GetBindingName(Binding));
+		Entry.Slots.Add(Slot);
+
+		if (IsBindingBound(Binding.Key))
+		{
+			Entry.NumBound++;
+			//Keep the first one when loaded data holds duplicates.
+			if (!ByBinding.Contains(FRequenceBindingKey(GetBindingName(Binding), Binding.Key)))
+			{
+				ByBinding.Add(FRequenceBindingKey(GetBindingName(Binding), Binding.Key), Slot);
+			}
+		}
+	}
+
+	//Call after changing the key of Bindings[Slot], name unchanged.
+	void OnKeyChanged(const TArray<BindingType>& Bindings, int32 Slot, const FKey& OldKey)
+	{
+		const BindingType& Binding = Bindings[Slot];
+		FRequenceBindingSlots* Entry = ByName.Find(GetBindingName(Binding));
+		if (Entry == nullptr)
+		{
+			MarkDirty();
+			return;
+		}
+
+		if (IsBindingBound(OldKey))
+		{
+			Entry->NumBound--;
+
+			const FRequenceBindingKey OldBinding(GetBindingName(Binding), OldKey);
+			if (ByBinding.FindRef(OldBinding) == Slot)
+			{
+				ByBinding.Remove(OldBinding);
+				for (int32 Other : Entry->Slots)
+				{
+					if (Other != Slot && Bindings[Other].Key == OldKey)
+					{
+						ByBinding.Add(OldBinding, Other);
+						break;
+					}
+				}
+			}
+		}
+
+		if (IsBindingBound(Binding.Key))
+		{
+			Entry->NumBound++;
+
+			const FRequenceBindingKey NewBinding(GetBindingName(Binding), Binding.Key);
+			int32* Existing = ByBinding.Find(NewBinding);
+			if (Existing == nullptr) { ByBinding.Add(NewBinding, Slot); }
+			else if (*Existing > Slot) { *Existing = Slot; }
+		}
+	}
+
+	const FRequenceBindingSlots* FindSlots(const FName Name) const
+	{
+		return ByName.Find(Name);
+	}
+
+	//First slot with this name and key, INDEX_NONE if there is none. An unbound key finds the first empty slot.
+	int32 FindSlot(const TArray<BindingType>& Bindings, const FName Name, const FKey& Key) const
+	{
+		if (IsBindingBound(Key))
+		{
+			const int32* Slot = ByBinding.Find(FRequenceBindingKey(Name, Key));
+			return Slot ? *Slot : INDEX_NONE;
+		}
+
+		if (const FRequenceBindingSlots* Entry = ByName.Find(Name))
+		{
+			for (int32 Slot : Entry->Slots)
+			{
+				if (!IsBindingBound(Bindings[Slot].Key)) { return Slot; }
+			}
+		}
+		return INDEX_NONE;
+	}
+
+private:
+	TMap<FName, FRequenceBindingSlots> ByName;
+	TMap<FRequenceBindingKey, int32> ByBinding;		//Bound bindings only
+	bool bDirty = true;
+};
+
+//Engine key mappings compiled from the bound actions and axises of a device. Not modified once built.
+struct FRequenceEngineMappings
+{
+	TArray<FInputActionKeyMapping> Actions;
+	TArray<FInputAxisKeyMapping> Axises;
+};
+
+//What URequenceDevice::Reconcile changed, one name per binding slot.
+struct FRequenceReconcileResult
+{
+	TArray<FName> AddedActions;
+	TArray<FName> RemovedActions;
+	TArray<FName> AddedAxises;
+	TArray<FName> RemovedAxises;
+};
+
 /*
 *  Danny de Bruijne (2018)
 *  RequenceDevice
@@ -26,47 +199,80 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)		FString DeviceString = "Unknown";
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)		FString DeviceName = "Unknown";
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)		ERequenceDeviceType DeviceType = ERequenceDeviceType::RDT_Unknown;
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)		TArray<FRequenceInputAction> Actions;
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)		TArray<FRequenceInputAxis> Axises;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)		TArray<FRequenceInputAction> Actions;	//Sorted by name
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)		TArray<FRequenceInputAxis> Axises;		//Sorted by name
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	bool Updated = false;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	bool Connected = false;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)	URequence* RequenceRef;
 
 	URequenceDevice();
 
-	//Returns the device type by a bound key
-	static ERequenceDeviceType GetDeviceTypeByKeyString(FString KeyString);
-	UFUNCTION(BlueprintCallable) ERequenceDeviceType GetDeviceTypeByKey(FKey Key);
+	//Returns the device type by the name of a bound key. Prefer GetDeviceTypeByKey, this only goes by naming conventions.
+	static ERequenceDeviceType GetDeviceTypeByKeyString(const FString& KeyString);
+
+	//Returns the device type of a bound key. A single lookup, see FRequenceKeyTypes.
+	UFUNCTION(BlueprintCallable) ERequenceDeviceType GetDeviceTypeByKey(const FKey& Key);
 
 	//Returns the device name by the set device key. Will return Unknown for unique devices.
 	static FString GetDeviceNameByType(ERequenceDeviceType DeviceType);
 
-	//Loops through all axises and actions and applies the CompactifyName function on the Action/Axis name.
-	UFUNCTION() void CompactifyAllKeyNames();
+	//Display string of a bound key, empty when unbound. Bindings don't store it, ask for it when displaying them.
+	UFUNCTION(BlueprintCallable) FString GenerateKeyString(const FKey& key, bool bDoCompactify);
 
-	//Returns a new struct with updated KeyString
-	UFUNCTION(BlueprintCallable) FRequenceInputAction UpdateKeyStringAction(FRequenceInputAction Action, bool bDoCompactify);
+	//Filters the name of an key so it's more compact.
+	UFUNCTION(BlueprintCallable) FString CompactifyKeyString(const FString& InName);
 
-	//Returns a new struct with updated KeyString
-	UFUNCTION(BlueprintCallable) FRequenceInputAxis UpdateKeyStringAxis(FRequenceInputAxis Axis, bool bDoCompactify);
+	//Display string of an action's key, what the removed KeyString member held. For Blueprints that read it off the binding.
+	UFUNCTION(BlueprintPure) FString GetActionKeyString(const FRequenceInputAction& Action, bool bDoCompactify);
 
-	//Generates a new keystring axis
-	UFUNCTION(BlueprintCallable) FString GenerateKeyString(FKey key, bool bDoCompactify);
+	//Display string of an axis' key, what the removed KeyString member held. For Blueprints that read it off the binding.
+	UFUNCTION(BlueprintPure) FString GetAxisKeyString(const FRequenceInputAxis& Axis, bool bDoCompactify);
 
-	//Filters the name of an key so it's more compact.
-	UFUNCTION(BlueprintCallable) FString CompactifyKeyString(FString InName);
+	//Deprecated, bindings no longer store a key string so there is nothing to compactify. Does nothing.
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Bindings no longer store a key string, use GetActionKeyString or GetAxisKeyString when displaying them."))
+	void CompactifyAllKeyNames();
+
+	//Deprecated, returns Action unchanged since it no longer stores a key string.
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Bindings no longer store a key string, use GetActionKeyString instead."))
+	FRequenceInputAction UpdateKeyStringAction(const FRequenceInputAction& Action, bool bDoCompactify);
+
+	//Deprecated, returns Axis unchanged since it no longer stores a key string.
+	UFUNCTION(BlueprintCallable, meta = (DeprecatedFunction, DeprecationMessage = "Bindings no longer store a key string, use GetAxisKeyString instead."))
+	FRequenceInputAxis UpdateKeyStringAxis(const FRequenceInputAxis& Axis, bool bDoCompactify);
 
-	//Bubble sorts the actions and axises based on name.
+	//Compact display string of a key. Computed once per key and kept for the lifetime of the process, the reference stays valid.
+	static const FString& GetCompactKeyString(const FKey& Key);
+
+	//Stable sorts the actions and axises based on name. They are kept sorted, so this is only needed after modifying them directly.
 	UFUNCTION(BlueprintCallable) void SortAlphabetically();
 
 	//Starts edit mode for this device. returns success.
 	UFUNCTION(BlueprintCallable) bool StartEditMode();
 
+	//Brings the bindings in line with the full action/axis lists in one pass: removes the ones no longer in them (unless !bRemoveDeleted),
+	//and adds empty ones until every name has numRequired. Reports what changed in OutResult when given. Returns whether anything changed.
+	bool Reconcile(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList, int numRequired = 2, bool bRemoveDeleted = true, FRequenceReconcileResult* OutResult = nullptr);
+
 	//Adds all not-found axises and actions from the full action list.
-	UFUNCTION()	void AddAllEmpty(TArray<FString> FullAxisList, TArray<FString> FullActionList, int numRequired = 2);
+	UFUNCTION()	void AddAllEmpty(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList, int numRequired = 2);
 
 	//Removes all actions and axises that are no longer found in the full action/axis list. returns whether axises are removed.
-	UFUNCTION() bool FilterDeleted(TArray<FString> FullAxisList, TArray<FString> FullActionList);
+	UFUNCTION() bool FilterDeleted(const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList);
+
+	//Call after modifying Actions or Axises directly, so the binding lookups get rebuilt.
+	void MarkBindingIndexDirty();
+
+	//Flags the device as updated and bumps its generation, so the next ApplyAxisesAndActions patches its mappings.
+	void MarkBindingsChanged() { Updated = true; BumpBindingsGeneration(); }
+
+	//Changes with every modification of the bindings or physical data.
+	uint32 GetBindingsGeneration() const { return BindingsGeneration; }
+
+	//Changes whenever any device is created or changes its bindings. Lets caches over all devices skip the per-device checks.
+	static uint32 GetAllBindingsGeneration() { return AllBindingsGeneration; }
+
+	//Every bound action and axis as engine key mappings, in binding order. The same object is returned until the generation changes.
+	TSharedRef<const FRequenceEngineMappings> GetEngineMappings() const;
 
 
 	//////////////////////////////////////////////////////////////////////////
@@ -74,46 +280,46 @@ public:
 	//////////////////////////////////////////////////////////////////////////
 
 	//Check whether the provided action is already in the list.
-	UFUNCTION(BlueprintCallable) bool HasActionBinding(FString ActionName, bool MustBeBound);
+	UFUNCTION(BlueprintCallable) bool HasActionBinding(FName ActionName, bool MustBeBound);
 
 	//Check whether the provided axis is already in the list.
-	UFUNCTION(BlueprintCallable) bool HasAxisBinding(FString AxisName, bool MustBeBound);
+	UFUNCTION(BlueprintCallable) bool HasAxisBinding(FName AxisName, bool MustBeBound);
 
 	//Check how many of one action binding are already in the list.
-	UFUNCTION(BlueprintCallable) int HasNumOfActionBinding(FString ActionName, bool bMustBeBound);
+	UFUNCTION(BlueprintCallable) int HasNumOfActionBinding(FName ActionName, bool bMustBeBound);
 
 	//Check how many of one axis binding are already in the list.
-	UFUNCTION(BlueprintCallable) int HasNumOfAxisBinding(FString AxisName, bool bMustBeBound);
+	UFUNCTION(BlueprintCallable) int HasNumOfAxisBinding(FName AxisName, bool bMustBeBound);
 
 	//Adds a new action to this device. Checks for doubles. returns success.
-	UFUNCTION(BlueprintCallable) bool AddAction(FRequenceInputAction _action);
+	UFUNCTION(BlueprintCallable) bool AddAction(const FRequenceInputAction& _action);
 
 	//Adds a new axis to this device. Checks for doubles. returns success.
-	UFUNCTION(BlueprintCallable) bool AddAxis(FRequenceInputAxis _axis);
+	UFUNCTION(BlueprintCallable) bool AddAxis(const FRequenceInputAxis& _axis);
 
 	//Rebinds action. ActionName must be the same. returns success.
-	UFUNCTION(BlueprintCallable) bool RebindAction(FRequenceInputAction OldAction, FRequenceInputAction UpdatedAction);
+	UFUNCTION(BlueprintCallable) bool RebindAction(const FRequenceInputAction& OldAction, const FRequenceInputAction& UpdatedAction);
 
 	//Rebinds Axis. AxisName must be the same. returns success.
-	UFUNCTION(BlueprintCallable) bool RebindAxis(FRequenceInputAxis OldAxis, FRequenceInputAxis UpdatedAxis);
+	UFUNCTION(BlueprintCallable) bool RebindAxis(const FRequenceInputAxis& OldAxis, const FRequenceInputAxis& UpdatedAxis);
 
 	//Deletes action by string. returns success. bLeaveActionName leaves your struct in the array if you don't want to create news but rebind
-	UFUNCTION(BlueprintCallable) bool DeleteActionKeys(FString ActionName);
+	UFUNCTION(BlueprintCallable) bool DeleteActionKeys(FName ActionName);
 
 	//Deletes axis by string. returns success. bLeaveAxisName leaves your struct in the array if you don't want to create news but rebind
-	UFUNCTION(BlueprintCallable) bool DeleteAxisKeys(FString AxisName);
+	UFUNCTION(BlueprintCallable) bool DeleteAxisKeys(FName AxisName);
 
 
 	//////////////////////////////////////////////////////////////////////////
 	// JSON Import/Export
 	//////////////////////////////////////////////////////////////////////////
 
-	//Fills this device from a requence save object device.
-	virtual void FromStruct(FRequenceSaveObjectDevice StructIn, URequence* _RequenceRef,
-				TArray<FString> FullAxisList, TArray<FString> FullActionList);
+	//Fills this device from a requence save object device. Takes over its arrays, StructIn is left empty.
+	virtual void FromStruct(FRequenceSaveObjectDevice&& StructIn, URequence* _RequenceRef,
+				const TArray<FName>& FullAxisList, const TArray<FName>& FullActionList);
 
 	//Creates a save object device from this device.
-	virtual FRequenceSaveObjectDevice ToStruct();
+	virtual FRequenceSaveObjectDevice ToStruct() const;
 
 	//Retrieves this class' data as a JSON object.
 	virtual TSharedPtr<FJsonObject> GetDeviceAsJson();
@@ -125,9 +331,26 @@ public:
 	TArray<TSharedPtr<FJsonValue>> GetAxisesAsJson();
 
 	//Parses and adds actions in JSON format to this device.
-	void SetJsonAsActions(TArray<TSharedPtr<FJsonValue>> _Actions);
+	void SetJsonAsActions(const TArray<TSharedPtr<FJsonValue>>& _Actions);
 
 	//Parses and adds axises in JSON format to this device.
-	void SetJsonAsAxises(TArray<TSharedPtr<FJsonValue>> _Axises);
+	void SetJsonAsAxises(const TArray<TSharedPtr<FJsonValue>>& _Axises);
+
+private:
+	//Lookups over Actions and Axises.
+	TRequenceBindingIndex<FRequenceInputAction> ActionIndex;
+	TRequenceBindingIndex<FRequenceInputAxis> AxisIndex;
+
+	uint32 BindingsGeneration = 0;
+	static uint32 AllBindingsGeneration;
+
+	void BumpBindingsGeneration() { BindingsGeneration++; AllBindingsGeneration++; }
+
+	//See GetEngineMappings.
+	mutable TSharedPtr<const FRequenceEngineMappings> EngineMappings;
+	mutable uint32 EngineMappingsGeneration = 0;
+
+	//Bumps the generation for a single binding change and tells the owner's key index about it.
+	void MarkBindingMoved(bool bIsAxis, FName OldName, const FRequenceKeyChord& OldChord, FName NewName, const FRequenceKeyChord& NewChord);
 
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArrayView.h"
+#include "RequenceStructs.h"
+
+class URequenceDevice;
+
+/*
+*  FRequenceDeviceRegistry
+*
+*  Devices of a URequence indexed by type, by DeviceString and by hardware identity, so finding one is a single lookup.
+*  Holds no references of its own, the owner keeps the devices alive and reports every device it adds, removes or renames.
+*  Several devices can share a DeviceString or hardware ID (two of the same joystick). Units of a model are told apart by their
+*  hardware ordinal, the other lookups return the first one added.
+*/
+class REQUENCEPLUGIN_API FRequenceDeviceRegistry
+{
+public:
+	//Indexes a device under its current type, DeviceString and hardware identity.
+	void Add(URequenceDevice* Device);
+
+	void Remove(URequenceDevice* Device);
+
+	void Reset();
+
+	//Sets the DeviceString and, for unique devices, the hardware ID and ordinal of a registered device, and re-indexes it.
+	void SetIdentity(URequenceDevice* Device, const FString& DeviceString, const FString& HardwareID, int32 HardwareOrdinal);
+
+	//nullptr when there is none.
+	URequenceDevice* FindByType(ERequenceDeviceType DeviceType) const;
+	URequenceDevice* FindByString(const FString& DeviceString) const;
+	URequenceDevice* FindByHardwareID(const FString& HardwareID, int32 HardwareOrdinal) const;
+
+	//Every device with this DeviceString or hardware ID, in the order they were added. Valid until the registry changes.
+	TArrayView<URequenceDevice* const> FindAllByString(const FString& DeviceString) const;
+	TArrayView<URequenceDevice* const> FindAllByHardwareID(const FString& HardwareID) const;
+
+	//Every device of a type, in the order they were added. Valid until the registry changes.
+	TArrayView<URequenceDevice* const> GetDevicesOfType(ERequenceDeviceType DeviceType) const;
+
+private:
+	typedef TArray<URequenceDevice*, TInlineAllocator<1>> FDeviceList;
+
+	static const int32 NumDeviceTypes = (int32)ERequenceDeviceType::RDT_Unique + 1;
+
+	TArray<URequenceDevice*> ByType[NumDeviceTypes];
+	TMap<FString, FDeviceList> ByString;
+	TMap<FString, FDeviceList> ByHardwareID;
+
+	static const FString& GetHardwareID(const URequenceDevice* Device);
+	static void AddTo(TMap<FString, FDeviceList>& Map, const FString& Key, URequenceDevice* Device);
+	static void RemoveFrom(TMap<FString, FDeviceList>& Map, const FString& Key, URequenceDevice* Device);
+	static URequenceDevice* FindIn(const TMap<FString, FDeviceList>& Map, const FString& Key);
+	static TArrayView<URequenceDevice* const> FindAllIn(const TMap<FString, FDeviceList>& Map, const FString& Key);
+};
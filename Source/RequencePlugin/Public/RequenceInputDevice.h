@@ -7,36 +7,87 @@
 #include "IInputDevice.h"
 #include "InputCoreTypes.h"
 
-#include "SDL.h"
-#include "SDL_joystick.h"
+#include "RequenceStructs.h"
+#include "RequenceSaveObject.h"
+#include "RequenceInputSources.h"
+#include "RequenceInputRecording.h"
+#include "RequenceLatency.h"
 
 DECLARE_MULTICAST_DELEGATE(FRIDUpdate);
 
+//Decoded SDL hat mask.
+struct FRequenceHatDirection
+{
+	int8 Direction;		//Index into RequenceInputDevice::_HatDirections, INDEX_NONE when centered.
+	int8 X;
+	int8 Y;
+};
+
 struct FHatData
 {
-	int HatID;
-	TMap<uint8, FKey> Buttons;
-	TMap<FString, FKey> Axises;
+	int HatID = 0;
+	FKey Buttons[8];	//Indexed by FRequenceHatDirection::Direction
+	FKey Axises[2];		//X, Y
 
 	FHatData() {}
 };
 
+//Physical axis settings of one device axis, compiled from the Requence save file. Only holds what Apply reads.
+struct FRequenceAxisTransform
+{
+	bool bHasPhysicalData = false;
+	ERequencePAInputRange InputRange = ERequencePAInputRange::RPAIR_Default;
+	float DeadZone = 0.f;
+	float ChangeThreshold = 0.f;
+	TSharedPtr<const FRequenceBakedCurve> Curve;	//Shared with the physical axis, null without data points
+	FName AxisName;									//For verification warnings
+
+	FRequenceAxisTransform() {}
+	FRequenceAxisTransform(const FRequencePhysicalAxis& InPhysicalAxis)
+		: bHasPhysicalData(true), InputRange(InPhysicalAxis.InputRange), DeadZone(InPhysicalAxis.DeadZone), ChangeThreshold(InPhysicalAxis.ChangeThreshold),
+		Curve(InPhysicalAxis.BakedCurve), AxisName(*InPhysicalAxis.Axis)
+	{ }
+
+	//Applies dead zone, input range and curve to a normalized axis value. bVerify also evaluates the exact curve and warns when the baked one drifts.
+	float Apply(float Value, bool bVerify = false) const;
+};
+
 struct FSDLDeviceInfo
 {
 	int Which;
 	int InstanceID;
 	FString Name;
+	FString HardwareID;		//See FRequenceDeviceDescriptor
 
 	SDL_Joystick* Joystick = nullptr;
 
-	TMap<int, float> OldAxisState;	//Map<AxisID, float pos>
-	TMap<int, FKey> Axises;			//Map<ButtonID, FKey>
+	//SDL indices are dense and start at 0, so all state is stored in arrays indexed by them.
+	TArray<float> OldAxisState;		//Array<AxisID, float pos>
+	TArray<FKey> Axises;			//Array<AxisID, FKey>
+
+	TBitArray<> OldButtonState;		//Bits<ButtonID, Down>
+	TArray<FKey> Buttons;			//Array<ButtonID, FKey>
+
+	TArray<uint8> OldHatState;		//Array<HatID, SDL_HAT_STATE>
+	TArray<FHatData> HatKeys;		//Array<HatID, FHatData>
+
+	TArray<FRequenceAxisTransform> AxisTransforms;	//Indexed by AxisID
+
+	TArray<int16> PendingAxisValue;	//Array<AxisID, latest raw position this frame>
+	TArray<uint32> PendingAxisReceiveCycles;	//Array<AxisID, FRequenceInputEvent::ReceiveCycles of the pending position>
+	TBitArray<> PendingAxisDirty;	//Bits<AxisID, has a pending position>
 
-	TMap<int, bool> OldButtonState;	//Map<ButtonID, Bool Down>
-	TMap<int, FKey> Buttons;		//Map<ButtonID, FKey>
+	FRequenceLatencyTracker Latency;
 
-	TMap<int, uint8> OldHatState;	//Map<HatID, SDL_HAT_STATE>
-	TMap<int, FHatData> HatKeys;	//Map<HatID, FHatData>
+	//Last dispatch of every key as FPlatformTime::Cycles(), while RequenceInputDevice::bTrackConsumedLatency. 0 once consumed.
+	//Slots: buttons, then axises, then 8 buttons and 2 axises per hat.
+	TArray<uint32> KeyDispatchCycles;
+	int32 GetAxisKeySlot(int32 AxisID) const { return Buttons.Num() + AxisID; }
+	int32 GetHatKeySlot(int32 HatID, int32 Index) const { return Buttons.Num() + Axises.Num() + HatID * 10 + Index; }	//Index: direction, or 8 + axis
+
+	int64 NumEvents = 0;			//Handled since connecting
+	int64 NumEventsAtLastRate = 0;
+	float EventRate = 0.f;			//Events per second, updated every second
 
 	FSDLDeviceInfo() {}
 };
@@ -52,41 +103,137 @@ class REQUENCEPLUGIN_API RequenceInputDevice : public IInputDevice
 public:
 	TArray<FString> _HatDirections = {	"Down",	"LeftDown", "Left", "LeftUp", 
 										"Up", "RightUp", "Right", "RightDown" };
-	TArray<uint8>	_HatDirectionMap = { SDL_HAT_DOWN, SDL_HAT_LEFTDOWN, SDL_HAT_LEFT, SDL_HAT_LEFTUP, 
-										 SDL_HAT_UP, SDL_HAT_RIGHTUP, SDL_HAT_RIGHT, SDL_HAT_RIGHTDOWN };
 	TArray<FString> _HatAxises = { "X", "Y" };
 
+	//Every 4-bit SDL hat mask decoded to a direction and vector. Impossible masks (eg. up and down) decode as centered.
+	static const FRequenceHatDirection HatDirectionTable[16];
+
 	FRIDUpdate OnDevicesUpdated;
-	bool bOwnsSDL = false;
-	TArray<FSDLDeviceInfo> Devices;
+	//Connected devices. Slots stay put across hotplug, look them up through GetDeviceIndexByInstanceID.
+	TSparseArray<FSDLDeviceInfo> Devices;
 	TArray<FRequenceSaveObjectDevice> DeviceProperties;
 
+	//Check baked axis curves against the exact curve on every sample. Debugging only, this is slow.
+	bool bVerifyBakedCurves = false;
+
+	//Only send the latest position of every axis once per frame. Disable if you need every single sample.
+	//Pending positions are flushed before any button or hat event, so event order is kept.
+	bool bCoalesceAxisEvents = true;
+
+	//Drop axis events whose output did not move past the physical axis' change threshold.
+	bool bFilterAxisEvents = true;
+
+	//Measure per-device input latency, see GetLatency.
+	bool bTrackLatency = true;
+
+	//Remember when every key was dispatched, for ReportInputConsumed. Turned on by the first report.
+	bool bTrackConsumedLatency = false;
+
+	//Handles input without side effects outside of this device: nothing is sent to Slate, no keys are added to EKeys
+	//and the save slot is not read. Set on construction, so a benchmark can run inside a live game.
+	const bool bHeadless = false;
+
 	RequenceInputDevice() {}
 	RequenceInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler);
+	//Reads from the given source. When not threaded, the source is pumped from SendControllerEvents instead.
+	//Headless devices are for benchmarks, see bHeadless.
+	RequenceInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler, const TSharedRef<IRequenceInputSource>& InSource, bool bThreaded, bool bInHeadless = false);
 	~RequenceInputDevice();
 
-	void InitSDL();
-	static int HandleSDLEvent(void* UserData, SDL_Event* e);
-	bool AddDevice(int Which);
+	void InitInput(const TSharedRef<IRequenceInputSource>& InSource, bool bThreaded);
+	void HandleInputEvent(const FRequenceInputEvent& Event);
+	bool AddDevice(const FRequenceDeviceDescriptor& Descriptor);
 	bool RemDevice(int InstanceID);
 	int GetDeviceIndexByInstanceID(int InstanceID);
 	void LoadRequenceDeviceProperties();
 
-	void HandleInput_Hat(SDL_Event* e);
-	void HandleInput_Button(SDL_Event* e);
-	void HandleInput_Axis(SDL_Event* e);
+	//Replaces the physical axis settings of a device and recompiles it when connected.
+	void SetPhysicalAxises(const FString& DeviceString, const TArray<FRequencePhysicalAxis>& PhysicalAxises);
+
+	//Builds the per-axis transform table of a device from DeviceProperties.
+	void CompileAxisTransforms(FSDLDeviceInfo& Device) const;
 
-	FVector2D HatStateToVector(uint8 SDL_HAT_STATE);
+	void HandleInput_Hat(const FRequenceInputEvent& e);
+	void HandleInput_Button(const FRequenceInputEvent& e);
+	void HandleInput_Axis(const FRequenceInputEvent& e);
+
+	//Transforms a raw SDL axis position and sends it to Slate, unless filtered.
+	void DispatchAxis(FSDLDeviceInfo& Device, int AxisID, int16 RawValue, uint32 ReceiveCycles = 0);
+
+	//Sends the latest position of every axis that moved since the last flush.
+	void FlushCoalescedAxises();
+
+	//Records everything handled from now on, see FRequenceInputRecorder. Also started by -RequenceRecord=<File>.
+	bool StartRecording(const FString& Filename);
+	void StopRecording();
+	bool IsRecording() const { return Recorder.IsRecording(); }
+
+	//Call when a bound action or axis fired, to measure the time from dispatching its key to the game using it.
+	void ReportInputConsumed(const FKey& Key);
+
+	//Latency percentiles of every connected device.
+	void GetLatency(TArray<FRequenceDeviceLatency>& OutLatency) const;
+	void ResetLatency();
+
+	static const FRequenceHatDirection& DecodeHat(uint8 SDL_HAT_STATE) { return HatDirectionTable[SDL_HAT_STATE & 0xF]; }
+	static FVector2D HatStateToVector(uint8 SDL_HAT_STATE);
 
 	//InputDevice Interface
 	virtual void Tick(float DeltaTime) override;
 	virtual void SendControllerEvents() override;
 	virtual void SetMessageHandler(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) override {}
-	virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override { return false; }
+	virtual bool Exec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) override;
 	virtual void SetChannelValue(int32 ControllerId, FForceFeedbackChannelType ChannelType, float Value) override {}
 	virtual void SetChannelValues(int32 ControllerId, const FForceFeedbackValues &values) override {}
 
 private:
 	TSharedRef<FGenericApplicationMessageHandler> MessageHandler;
 
+	//Devices slot per SDL instance ID, INDEX_NONE when disconnected. SDL never reuses instance IDs within a session,
+	//so an instance ID doubles as a generational handle: a stale ID simply maps to INDEX_NONE.
+	TArray<int32> InstanceSlots;
+
+	//Axises with a pending coalesced position, in order of first movement. X: InstanceID, Y: AxisID.
+	TArray<FIntPoint> DirtyAxises;
+
+	//Where events come from, SDL unless started with -RequenceSynthetic or -RequenceReplay=<File>.
+	TSharedPtr<IRequenceInputSource> InputSource;
+
+	//Filled by the input source, drained in SendControllerEvents.
+	TUniquePtr<FRequenceInputQueues> InputQueues;
+
+	//Pumps the input source off the game thread. Null when the source is pumped by SendControllerEvents.
+	TUniquePtr<FRequenceInputThread> InputThread;
+
+	//Captures the drained stream while recording.
+	FRequenceInputRecorder Recorder;
+
+	//Dispatch slot of every key of every device, see FSDLDeviceInfo::KeyDispatchCycles. X: InstanceID, Y: slot.
+	//Identical devices share key names, so a key can have several.
+	TMultiMap<FKey, FIntPoint> KeySlots;
+
+	//Last time EventRate was updated.
+	double LastEventRateTime = 0.0;
+
+	//Console commands, see Exec.
+	void ExecDevices(FOutputDevice& Ar) const;
+	void ExecRates(FOutputDevice& Ar) const;
+	void ExecLatency(const TCHAR* Cmd, FOutputDevice& Ar);
+	void ExecRecord(const TCHAR* Cmd, FOutputDevice& Ar);
+	void ExecBench(const TCHAR* Cmd, FOutputDevice& Ar);
+
+	//Records the poll wait of a handled event.
+	void RecordReceive(FSDLDeviceInfo& Device, const FRequenceInputEvent& e);
+
+	//Records the receive to dispatch latency of a dispatched event.
+	void RecordDispatch(FSDLDeviceInfo& Device, int32 KeySlot, uint32 ReceiveCycles);
+
+	//Registers a key of a connecting device with FRequenceKeyTypes. Returns whether it still has to be added to EKeys, never when headless.
+	bool RegisterDeviceKey(const FKey& Key) const;
+
+	//Slate output. Skipped when headless or when Slate is not running, eg. in a commandlet.
+	void SendKeyDown(const FKey& Key);
+	void SendKeyUp(const FKey& Key);
+	void SendAnalog(const FKey& Key, float Value);
+
 };
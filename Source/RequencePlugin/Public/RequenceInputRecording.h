@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Archive.h"
+#include "RequenceInputThread.h"
+
+class RequenceInputDevice;
+
+/*
+*  Requence input recording (.rqin)
+*
+*  Header: uint32 Magic, uint32 Version.
+*  Followed by records, each starting with a uint8 ERequenceRecordKind:
+*  - Event:			uint32 Timestamp, int32 InstanceID, uint8 Type, uint8 Index, int16 Value
+*  - DeviceAdded:	int32 Which, int32 InstanceID, FString Name, int32 NumAxises, int32 NumButtons, int32 NumHats
+*  - DeviceRemoved:	int32 InstanceID
+*  - Frame:			nothing, marks the end of a SendControllerEvents that handled events.
+*  Everything is little endian. Records are only ever appended, a truncated file replays up to its last whole record.
+*/
+enum class ERequenceRecordKind : uint8
+{
+	Event,
+	DeviceAdded,
+	DeviceRemoved,
+	Frame
+};
+
+//One record of a recording.
+struct FRequenceInputRecord
+{
+	ERequenceRecordKind Kind = ERequenceRecordKind::Event;
+	FRequenceInputEvent Event;				//Event
+	FRequenceDeviceDescriptor Device;		//DeviceAdded, DeviceRemoved (InstanceID only)
+};
+
+/*
+*  FRequenceInputRecorder
+*
+*  Appends everything RequenceInputDevice handles to a recording file.
+*/
+class REQUENCEPLUGIN_API FRequenceInputRecorder
+{
+public:
+	static const uint32 Magic = 0x4E495152;	//"RQIN"
+	static const uint32 Version = 1;
+
+	~FRequenceInputRecorder() { Stop(); }
+
+	//Where recordings with a relative path end up.
+	static FString GetDefaultRecordingPath() { return FPaths::ProjectSavedDir() + "InputRecordings/"; }
+
+	//Resolves a relative filename against GetDefaultRecordingPath and appends .rqin unless the name already ends in it.
+	static FString GetRecordingFilePath(const FString& Filename);
+
+	//Opens Filename (relative to GetDefaultRecordingPath, .rqin by default) and writes the header. Returns success.
+	bool Start(const FString& InFilename);
+	void Stop();
+	bool IsRecording() const { return Writer.IsValid(); }
+
+	void RecordEvent(const FRequenceInputEvent& Event);
+	void RecordDeviceAdded(const FRequenceDeviceDescriptor& Descriptor);
+	void RecordDeviceRemoved(int32 InstanceID);
+	void RecordFrame();
+
+	const FString& GetFilename() const { return Filename; }
+	int64 GetNumRecords() const { return NumRecords; }
+
+	//Shared by recorder and player, so both sides agree on the layout.
+	static void SerializeEvent(FArchive& Ar, FRequenceInputEvent& Event);
+	static void SerializeDevice(FArchive& Ar, FRequenceDeviceDescriptor& Descriptor);
+
+private:
+	TUniquePtr<FArchive> Writer;
+	FString Filename;
+	int64 NumRecords = 0;
+	bool bEventsSinceFrame = false;
+};
+
+/*
+*  FRequenceInputPlayer
+*
+*  Reads a recording back, either record by record or straight into a RequenceInputDevice.
+*/
+class REQUENCEPLUGIN_API FRequenceInputPlayer
+{
+public:
+	//Loads a whole recording into memory. Returns false when it is missing or not a recording.
+	bool Load(const FString& Filename);
+
+	//Reads the next record, false at the end.
+	bool ReadNext(FRequenceInputRecord& OutRecord);
+
+	//Back to the first record.
+	void Rewind() { Position = HeaderSize; }
+
+	bool IsLoaded() const { return Data.Num() >= HeaderSize; }
+
+	//Feeds every remaining record through the device's handlers, as fast as possible. Returns the amount of events handled.
+	int64 Replay(RequenceInputDevice& Device);
+
+private:
+	static const int32 HeaderSize = 8;
+
+	TArray<uint8> Data;
+	int64 Position = 0;
+};
+
+/*
+*  FRequenceReplayInputSource
+*
+*  Plays a recording back in real time, at the pace of its SDL timestamps.
+*/
+class REQUENCEPLUGIN_API FRequenceReplayInputSource : public IRequenceInputSource
+{
+public:
+	FRequenceReplayInputSource(const FString& InFilename) : Filename(InFilename) {}
+
+	//IRequenceInputSource Interface
+	virtual bool Init(FRequenceInputQueues& Queues) override;
+	virtual void Pump(FRequenceInputQueues& Queues) override;
+	virtual void Shutdown() override {}
+	virtual const TCHAR* GetName() const override { return TEXT("Replay"); }
+
+private:
+	FString Filename;
+	FRequenceInputPlayer Player;
+
+	FRequenceInputRecord Pending;
+	bool bHasPending = false;
+
+	double StartTime = 0.0;
+	int64 FirstTimestamp = -1;
+};
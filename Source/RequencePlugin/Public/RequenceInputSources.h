@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RequenceInputThread.h"
+
+//Last known state of a joystick, for sources that can't poll SDL events.
+struct FRequencePolledJoystick
+{
+	TArray<int16> Axises;
+	TArray<uint8> Buttons;
+	TArray<uint8> Hats;
+};
+
+/*
+*  FRequenceSDLInputSource
+*
+*  Reads SDL joysticks. Polls SDL events when it initialized SDL itself. When someone else owns SDL (eg. the engine on Linux),
+*  polling events would steal theirs, so it samples joystick state instead and turns changes into events.
+*/
+class REQUENCEPLUGIN_API FRequenceSDLInputSource : public IRequenceInputSource
+{
+public:
+	//Whether SDL was initialized by us (and thus is polled by us).
+	bool OwnsSDL() const { return bOwnsSDL; }
+
+	//IRequenceInputSource Interface
+	virtual bool Init(FRequenceInputQueues& Queues) override;
+	virtual void Pump(FRequenceInputQueues& Queues) override;
+	virtual void Shutdown() override;
+	virtual const TCHAR* GetName() const override { return TEXT("SDL"); }
+
+private:
+	void HandleSDLEvent(const SDL_Event& Event, FRequenceInputQueues& Queues);
+	void OpenDevice(int Which, FRequenceInputQueues& Queues);
+	void CloseDevice(int32 InstanceID, FRequenceInputQueues& Queues);
+
+	//Samples every open joystick and pushes an event per changed axis, button and hat. Also picks up hotplug.
+	void PollJoysticks(FRequenceInputQueues& Queues);
+	void PushPolledEvent(FRequenceInputQueues& Queues, int32 InstanceID, ERequenceInputEventType Type, int32 Index, int16 Value, uint32 Timestamp);
+
+	volatile bool bOwnsSDL = false;
+	TMap<int32, SDL_Joystick*> Joysticks;
+
+	//FPlatformTime::Cycles() when the previous pump drained SDL, and the time since then at the start of the current one.
+	uint32 LastDrainCycles = 0;
+	uint32 PollWaitCycles = 0;
+
+	//Only used when not owning SDL. Keyed by instance ID.
+	TMap<int32, FRequencePolledJoystick> PolledJoysticks;
+	bool bRescanJoysticks = true;
+	int32 LastNumJoysticks = 0;
+};
+
+//Settings of a synthetic input source.
+struct FRequenceSyntheticInputConfig
+{
+	int32 NumDevices = 1;
+	int32 NumAxises = 6;
+	int32 NumButtons = 16;
+	int32 NumHats = 1;
+
+	//Events per second, per axis/button/hat.
+	float AxisRate = 500.f;
+	float ButtonRate = 4.f;
+	float HatRate = 2.f;
+
+	//Random positions instead of smooth sweeps.
+	bool bRandomize = true;
+	int32 RandomSeed = 0;
+
+	//When set, these events are replayed in a loop instead of generating any. InstanceIDs are 0 to NumDevices-1.
+	TArray<FRequenceInputEvent> Script;
+};
+
+/*
+*  FRequenceSyntheticInputSource
+*
+*  Generates scripted or randomized joystick streams at fixed rates, without any hardware.
+*/
+class REQUENCEPLUGIN_API FRequenceSyntheticInputSource : public IRequenceInputSource
+{
+public:
+	FRequenceSyntheticInputConfig Config;
+
+	FRequenceSyntheticInputSource(const FRequenceSyntheticInputConfig& InConfig);
+
+	//Generates DeltaSeconds worth of events, interleaved in time, appending them to OutEvents.
+	void GenerateEvents(double DeltaSeconds, TArray<FRequenceInputEvent>& OutEvents);
+
+	//Generates exactly NumEvents events, appending them to OutEvents.
+	void GenerateEvents(int32 NumEvents, TArray<FRequenceInputEvent>& OutEvents);
+
+	//IRequenceInputSource Interface
+	virtual bool Init(FRequenceInputQueues& Queues) override;
+	virtual void Pump(FRequenceInputQueues& Queues) override;
+	virtual void Shutdown() override {}
+	virtual const TCHAR* GetName() const override { return TEXT("Synthetic"); }
+
+private:
+	FRequenceInputEvent MakeEvent(ERequenceInputEventType Type, int32 InstanceID, int32 Index);
+
+	FRandomStream Random;
+	double LastPumpTime = 0.0;
+	double ElapsedTime = 0.0;
+	double EventBudget = 0.0;
+	int32 ScriptPosition = 0;
+	uint32 GeneratedCount = 0;
+	TArray<FRequenceInputEvent> PumpBuffer;
+};
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Runnable.h"
+#include "RunnableThread.h"
+#include "ThreadSafeCounter.h"
+#include "Queue.h"
+#include "ScopeLock.h"
+
+#include "SDL.h"
+#include "SDL_joystick.h"
+
+enum class ERequenceInputEventType : uint8
+{
+	Button,
+	Hat,
+	Axis
+};
+
+//Compact joystick event as it travels from the input thread to the game thread.
+struct FRequenceInputEvent
+{
+	uint32 Timestamp = 0;		//SDL_Event::common.timestamp (ms)
+	int32 InstanceID = -1;		//SDL joystick instance
+	ERequenceInputEventType Type = ERequenceInputEventType::Button;
+	uint8 Index = 0;			//Button, hat or axis index
+	int16 Value = 0;			//Button state, hat mask or raw axis position
+	uint32 PollWaitCycles = 0;	//FPlatformTime cycles since the poll before the one that read the event, 0 when unknown. See FRequenceLatencyTracker::PollWait
+	uint32 ReceiveCycles = 0;	//FPlatformTime::Cycles() when Requence received the event, 0 when unknown
+};
+
+//Everything the game thread needs to register a device, gathered on the input thread.
+struct FRequenceDeviceDescriptor
+{
+	int Which = -1;
+	int InstanceID = -1;
+	FString Name;
+	FString HardwareID;					//SDL joystick GUID. Empty for synthetic and replayed devices.
+	SDL_Joystick* Joystick = nullptr;	//Owned by the input thread, do not close.
+	int NumAxises = 0;
+	int NumButtons = 0;
+	int NumHats = 0;
+};
+
+/*
+*  TRequenceEventRing
+*
+*  Bounded single-producer/single-consumer ring. Push from one thread, Pop from another.
+*  When full, new elements are dropped and counted instead of blocking the producer.
+*/
+template<typename ElementType, uint32 Capacity>
+class TRequenceEventRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Ring capacity must be a power of two.");
+
+public:
+	//Producer only.
+	bool Push(const ElementType& Element)
+	{
+		const uint32 Head = (uint32)HeadIndex.GetValue();
+		const uint32 Tail = (uint32)TailIndex.GetValue();
+		if (Head - Tail >= Capacity)
+		{
+			DroppedCount.Increment();
+			return false;
+		}
+
+		Elements[Head & (Capacity - 1)] = Element;
+		HeadIndex.Set((int32)(Head + 1));	//Publishes the element.
+		return true;
+	}
+
+	//Consumer only.
+	bool Pop(ElementType& OutElement)
+	{
+		const uint32 Tail = (uint32)TailIndex.GetValue();
+		const uint32 Head = (uint32)HeadIndex.GetValue();
+		if (Head == Tail) { return false; }
+
+		OutElement = Elements[Tail & (Capacity - 1)];
+		TailIndex.Set((int32)(Tail + 1));	//Hands the slot back to the producer.
+		return true;
+	}
+
+	int32 Num() const { return (int32)((uint32)HeadIndex.GetValue() - (uint32)TailIndex.GetValue()); }
+	int32 GetDroppedCount() const { return DroppedCount.GetValue(); }
+	static constexpr uint32 GetCapacity() { return Capacity; }
+
+private:
+	ElementType Elements[Capacity];
+	FThreadSafeCounter HeadIndex;
+	FThreadSafeCounter TailIndex;
+	FThreadSafeCounter DroppedCount;
+};
+
+//Everything an input source hands over to the game thread.
+struct FRequenceInputQueues
+{
+	//Capacity of the event ring, roughly a few frames of a full HOTAS setup.
+	static const uint32 EventCapacity = 4096;
+
+	TRequenceEventRing<FRequenceInputEvent, EventCapacity> Events;
+	TQueue<FRequenceDeviceDescriptor, EQueueMode::Spsc> AddedDevices;
+	TQueue<int32, EQueueMode::Spsc> RemovedDevices;
+
+	//Pushes an event, counting it against its device when the ring is full. Producer only.
+	bool PushEvent(const FRequenceInputEvent& Event)
+	{
+		if (Events.Push(Event)) { return true; }
+
+		//Only taken when dropping, which should be rare.
+		FScopeLock Lock(&DroppedLock);
+		DroppedPerDevice.FindOrAdd(Event.InstanceID)++;
+		return false;
+	}
+
+	//Events of a device dropped because the ring was full, since the queues were created.
+	int32 GetDroppedEvents(int32 InstanceID) const
+	{
+		FScopeLock Lock(&DroppedLock);
+		const int32* Dropped = DroppedPerDevice.Find(InstanceID);
+		return Dropped ? *Dropped : 0;
+	}
+
+private:
+	mutable FCriticalSection DroppedLock;
+	TMap<int32, int32> DroppedPerDevice;
+};
+
+/*
+*  IRequenceInputSource
+*
+*  Produces joystick events and hotplug notifications. Init, Pump and Shutdown are all called from the same thread.
+*/
+class REQUENCEPLUGIN_API IRequenceInputSource
+{
+public:
+	virtual ~IRequenceInputSource() {}
+
+	//Opens the source and announces the devices that are already connected. Returns success.
+	virtual bool Init(FRequenceInputQueues& Queues) = 0;
+
+	//Pushes everything that happened since the last pump.
+	virtual void Pump(FRequenceInputQueues& Queues) = 0;
+
+	//Closes all devices and releases the source.
+	virtual void Shutdown() = 0;
+
+	virtual const TCHAR* GetName() const = 0;
+};
+
+/*
+*  FRequenceInputThread
+*
+*  Pumps an input source independent of the frame rate, so the source (eg. SDL) is owned by this thread.
+*/
+class REQUENCEPLUGIN_API FRequenceInputThread : public FRunnable
+{
+public:
+	//Seconds between two pumps.
+	static constexpr float PollInterval = 0.001f;
+
+	FRequenceInputThread(const TSharedRef<IRequenceInputSource>& InSource, FRequenceInputQueues& InQueues);
+	virtual ~FRequenceInputThread();
+
+	//Starts the thread. Returns success.
+	bool Start();
+
+	//Stops the thread and waits for it to release the source.
+	void Shutdown();
+
+	//FRunnable Interface
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	virtual void Exit() override;
+
+private:
+	TSharedRef<IRequenceInputSource> Source;
+	FRequenceInputQueues& Queues;
+
+	FRunnableThread* Thread = nullptr;
+	FThreadSafeCounter StopRequested;
+};
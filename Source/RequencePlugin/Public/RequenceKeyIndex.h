@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ArrayView.h"
+#include "RequenceStructs.h"
+
+class URequenceDevice;
+
+//A key together with the modifiers that have to be held. Axises never have modifiers.
+struct FRequenceKeyChord
+{
+	enum EModifier : uint8
+	{
+		Shift	= 1 << 0,
+		Ctrl	= 1 << 1,
+		Alt		= 1 << 2,
+		Cmd		= 1 << 3
+	};
+
+	FKey Key;
+	uint8 Modifiers = 0;
+
+	FRequenceKeyChord() {}
+	FRequenceKeyChord(const FKey& InKey, uint8 InModifiers = 0) : Key(InKey), Modifiers(InModifiers) {}
+	FRequenceKeyChord(const FKey& InKey, bool bShift, bool bCtrl, bool bAlt, bool bCmd)
+		: Key(InKey), Modifiers((bShift ? Shift : 0) | (bCtrl ? Ctrl : 0) | (bAlt ? Alt : 0) | (bCmd ? Cmd : 0)) {}
+	FRequenceKeyChord(const FRequenceInputAction& Action) : FRequenceKeyChord(Action.Key, Action.bShift, Action.bCtrl, Action.bAlt, Action.bCmd) {}
+	FRequenceKeyChord(const FRequenceInputAxis& Axis) : Key(Axis.Key) {}
+
+	bool IsBound() const { return Key != FKey(); }
+
+	bool operator==(const FRequenceKeyChord& Other) const { return Key == Other.Key && Modifiers == Other.Modifiers; }
+	friend uint32 GetTypeHash(const FRequenceKeyChord& Chord) { return HashCombine(GetTypeHash(Chord.Key), Chord.Modifiers); }
+};
+
+//One bound action or axis slot of a device.
+struct FRequenceKeyBinding
+{
+	TWeakObjectPtr<URequenceDevice> Device;
+	FName Name;
+	bool bIsAxis = false;
+
+	FRequenceKeyBinding() {}
+	FRequenceKeyBinding(URequenceDevice* InDevice, FName InName, bool bInIsAxis) : Device(InDevice), Name(InName), bIsAxis(bInIsAxis) {}
+
+	bool operator==(const FRequenceKeyBinding& Other) const { return Device == Other.Device && Name == Other.Name && bIsAxis == Other.bIsAxis; }
+};
+
+/*
+*  FRequenceKeyIndex
+*
+*  Reverse index from key chord to every action and axis bound to it, over all devices. Devices report single key changes
+*  through OnBindingMoved. A device whose bindings changed any other way is noticed by its generation and re-indexed by Update.
+*/
+class REQUENCEPLUGIN_API FRequenceKeyIndex
+{
+public:
+	//Re-indexes devices that changed without reporting it and drops devices that are gone. Returns after one compare of the
+	//device list when no device was created or changed its bindings since the last call.
+	void Update(const TArray<URequenceDevice*>& Devices);
+
+	void Reset();
+
+	//Moves one binding of Device to another name and/or chord. Unbound chords are not indexed, so this also adds and removes.
+	//OldGeneration and NewGeneration are the device's generation around the change, ignored unless the index was up to date with it.
+	void OnBindingMoved(URequenceDevice* Device, uint32 OldGeneration, uint32 NewGeneration, bool bIsAxis,
+		FName OldName, const FRequenceKeyChord& OldChord, FName NewName, const FRequenceKeyChord& NewChord);
+
+	//Every binding on this chord, empty when there is none. Valid until the index changes.
+	TArrayView<const FRequenceKeyBinding> Find(const FRequenceKeyChord& Chord) const;
+
+private:
+	typedef TArray<FRequenceKeyBinding, TInlineAllocator<2>> FBindingList;
+
+	TMap<FRequenceKeyChord, FBindingList> ByChord;
+
+	//Generation of every indexed device at the time it was indexed.
+	TMap<TWeakObjectPtr<URequenceDevice>, uint32> IndexedGenerations;
+
+	//Device list and URequenceDevice::GetAllBindingsGeneration at the last Update, to return early when neither changed.
+	TArray<URequenceDevice*> IndexedDevices;
+	uint32 IndexedAllGeneration = 0;
+
+	void AddDevice(URequenceDevice* Device);
+	void RemoveDevice(const TWeakObjectPtr<URequenceDevice>& Device);
+	void Add(const FRequenceKeyChord& Chord, const FRequenceKeyBinding& Binding);
+	void Remove(const FRequenceKeyChord& Chord, const FRequenceKeyBinding& Binding);
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "RequenceStructs.h"
+
+/*
+*  FRequenceKeyTypes
+*
+*  Device type of every key, so classifying a key is one lookup. Filled from the engine's key details on first use, keys Requence
+*  creates for unique devices are registered by RequenceInputDevice::AddDevice. Game thread only.
+*/
+class REQUENCEPLUGIN_API FRequenceKeyTypes
+{
+public:
+	//Keys that are not known yet, such as unique device keys of a device that is not connected, are classified and added.
+	static ERequenceDeviceType Get(const FKey& Key);
+
+	//Marks a key as belonging to a unique device.
+	static void RegisterUniqueDeviceKey(const FKey& Key);
+
+private:
+	static TMap<FKey, ERequenceDeviceType>& GetTable();
+
+	//The engine's motion controller keys. Their key details only say they are gamepad keys.
+	static const TSet<FKey>& GetMotionControllerKeys();
+
+	//Classifies by the key details and GetMotionControllerKeys. The naming rules of URequenceDevice::GetDeviceTypeByKeyString are
+	//only used for keys the engine does not know and for plugin gamepad keys, see the definition.
+	static ERequenceDeviceType Classify(const FKey& Key);
+};
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RequenceStructs.h"
+
+/*
+*  FRequenceLatencyHistogram
+*
+*  Rolling histogram of latencies in microseconds. Buckets are log scale with 4 buckets per doubling, so percentiles
+*  are accurate to within 25%. Samples are kept for one to two windows: the current one and the one before.
+*/
+class REQUENCEPLUGIN_API FRequenceLatencyHistogram
+{
+public:
+	//The last bucket covers ~29 to ~33.5 seconds, anything above lands in it too.
+	static const int32 NumBuckets = 96;
+	static constexpr double WindowSeconds = 10.0;
+
+	FRequenceLatencyHistogram() { Reset(); }
+
+	void AddSample(uint32 Microseconds)
+	{
+		Buckets[Current][GetBucket(Microseconds)]++;
+		NumSamples[Current]++;
+		MaxSample[Current] = FMath::Max(MaxSample[Current], Microseconds);
+	}
+
+	//Starts a new window when the current one is older than WindowSeconds, dropping the oldest.
+	void Tick(double Now);
+
+	void Reset();
+
+	//Upper bound of the bucket holding the given percentile (0 to 1), in microseconds. 0 without samples.
+	uint32 GetPercentile(float Percentile) const;
+
+	int32 GetNumSamples() const { return NumSamples[0] + NumSamples[1]; }
+	uint32 GetMax() const { return FMath::Max(MaxSample[0], MaxSample[1]); }
+
+	//Percentiles in milliseconds.
+	FRequenceLatencyPercentiles GetPercentiles() const;
+
+	static int32 GetBucket(uint32 Microseconds);
+	static uint32 GetBucketUpperBound(int32 Bucket);
+
+private:
+	uint32 Buckets[2][NumBuckets];
+	int32 NumSamples[2];
+	uint32 MaxSample[2];
+
+	int32 Current = 0;
+	double WindowStart = -1.0;
+};
+
+//Latency of every stage of the input pipeline of one device.
+struct FRequenceLatencyTracker
+{
+	//Time between two SDL polls, the most an event can have waited for us once SDL could see it.
+	//An upper bound, not a measurement: driver and USB polling delays before that are invisible to Requence.
+	FRequenceLatencyHistogram PollWait;
+	FRequenceLatencyHistogram ReceiveToDispatch;
+	FRequenceLatencyHistogram DispatchToConsumed;
+
+	void Tick(double Now)
+	{
+		PollWait.Tick(Now);
+		ReceiveToDispatch.Tick(Now);
+		DispatchToConsumed.Tick(Now);
+	}
+
+	void Reset()
+	{
+		PollWait.Reset();
+		ReceiveToDispatch.Reset();
+		DispatchToConsumed.Reset();
+	}
+
+	//Microseconds between two FPlatformTime::Cycles() stamps, wrap around included.
+	static uint32 CyclesToMicroseconds(uint32 Cycles) { return (uint32)FMath::Min(Cycles * FPlatformTime::GetSecondsPerCycle() * 1000000.0, (double)MAX_uint32); }
+};
@@ -9,7 +9,7 @@
 class FRequencePluginModule : public IRequencePlugin
 {
 private:
-	void* SDLLibrary;
+	void* SDLLibrary = nullptr;
 
 public:
 	virtual TSharedPtr<class IInputDevice> CreateInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) override;
@@ -20,6 +20,8 @@ public:
 	UPROPERTY()		TArray<FRequenceInputAxis> Axises;		//Note: filtered without empty actions.
 
 	//Unique device data
+	UPROPERTY()		FString HardwareID;		//Empty in saves from before it was stored.
+	UPROPERTY()		int32 HardwareOrdinal = 0;	//0 in saves from before it was stored.
 	UPROPERTY()		TArray<FString> PhysicalButtons;
 	UPROPERTY()		TArray<FRequencePhysicalAxis> PhysicalAxises;
 
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats.h"
+
+//Shown by "stat Requence".
+DECLARE_STATS_GROUP(TEXT("Requence"), STATGROUP_Requence, STATCAT_Advanced);
+
+//Input thread
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleSDLEvent"), STAT_Requence_HandleSDLEvent, STATGROUP_Requence, REQUENCEPLUGIN_API);
+
+//Input device
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SendControllerEvents"), STAT_Requence_SendControllerEvents, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleInput_Hat"), STAT_Requence_HandleInputHat, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleInput_Button"), STAT_Requence_HandleInputButton, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleInput_Axis"), STAT_Requence_HandleInputAxis, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FlushCoalescedAxises"), STAT_Requence_FlushCoalescedAxises, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AddDevice"), STAT_Requence_AddDevice, STATGROUP_Requence, REQUENCEPLUGIN_API);
+
+//Bindings
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyAxisesAndActions"), STAT_Requence_ApplyAxisesAndActions, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("LoadInput"), STAT_Requence_LoadInput, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SaveInput"), STAT_Requence_SaveInput, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RequenceInputDevicesUpdated"), STAT_Requence_InputDevicesUpdated, STATGROUP_Requence, REQUENCEPLUGIN_API);
+
+//Per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Events"), STAT_Requence_NumEvents, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Axis events sent"), STAT_Requence_NumAxisDispatches, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Coalesced axises"), STAT_Requence_NumCoalescedAxises, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Event queue depth"), STAT_Requence_EventQueueDepth, STATGROUP_Requence, REQUENCEPLUGIN_API);
+
+//Totals
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Dropped events"), STAT_Requence_NumDroppedEvents, STATGROUP_Requence, REQUENCEPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Devices"), STAT_Requence_NumDevices, STATGROUP_Requence, REQUENCEPLUGIN_API);
@@ -4,6 +4,8 @@
 #include "GameFramework/PlayerInput.h"
 #include "RequenceStructs.generated.h"
 
+class URequenceDevice;
+
 template<typename TEnum>
 static FORCEINLINE FString EnumToString(const FString& Name, TEnum Value)
 {
@@ -55,6 +57,30 @@ enum class ERequencePAInputRange : uint8
 	RPAIR_HalvedNegative	UMETA(DisplayName = "Halved (-1 to 0)")
 };
 
+//Precached physical axis curve sampled on a uniform grid over -1 to 1, with the slope of every cell.
+//Immutable once built, so copies of an axis and compiled axis transforms share one.
+struct REQUENCEPLUGIN_API FRequenceBakedCurve
+{
+	//Number of cells between -1 and 1.
+	static const int32 Resolution = 1024;
+
+	TArray<FVector2D> Points;	//Precached data points it was sampled from, for EvaluateExact
+	TArray<float> Values;		//Resolution + 1 samples
+	TArray<float> Slopes;		//Resolution cells
+
+	//Largest difference between baked and exact curve we accept when verifying. A kink inside a cell is off by up to
+	//half a cell times the steepest slope, so steeper curves get more slack.
+	float Tolerance = 0.f;
+
+	FRequenceBakedCurve(const TArray<FVector2D>& InPoints);
+
+	//Cost does not depend on the number of data points.
+	float Evaluate(float Value) const;
+
+	//Searches the data points.
+	float EvaluateExact(float Value) const;
+};
+
 USTRUCT(BlueprintType)
 struct FRequencePhysicalAxis
 {
@@ -71,9 +97,19 @@ public:
 	//Input range setting
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) ERequencePAInputRange InputRange;
 
+	//Inputs closer to the rest position than this count as resting, the rest of the range is rescaled. 0 to 1.
+	//Measured after the input range mapping, so on halved axises it is a fraction of pedal travel.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) float DeadZone = 0.f;
+
+	//Minimum change of the output before it is sent again. 0 sends every change.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) float ChangeThreshold = 0.f;
+
 	//Whether datapoints are precached. DO NOT SAVE IF PRECACHED.
 	UPROPERTY() bool bIsPrecached = false;
 
+	//Built by BakeCurve, never saved. Null when not precached or without data points.
+	TSharedPtr<const FRequenceBakedCurve> BakedCurve;
+
 	FRequencePhysicalAxis() { InputRange = ERequencePAInputRange::RPAIR_Default; }
 	FRequencePhysicalAxis(FString _Axis) 
 	{
@@ -94,7 +130,25 @@ public:
 
 		DataPoints = Precached;
 		bIsPrecached = true;
+
+		BakeCurve();
 	}
+
+	//Applies the dead zone to an input already mapped to its input range, rest position 0.
+	float ApplyDeadZone(float Value) const { return ApplyDeadZone(Value, DeadZone); }
+	static float ApplyDeadZone(float Value, float DeadZone);
+
+	//Samples the precached curve into BakedCurve.
+	void BakeCurve();
+
+	//Evaluates the baked curve. Cost does not depend on the number of data points. Falls back to the exact curve when not baked.
+	float EvaluateBaked(float Value) const;
+
+	//Evaluates the precached curve by searching its data points.
+	float EvaluateExact(float Value) const;
+
+	//Returns the largest absolute difference between the baked and the exact curve over NumSamples inputs.
+	float MeasureBakedCurveError(int32 NumSamples = 8192) const;
 };
 
 USTRUCT(BlueprintType)
@@ -103,8 +157,8 @@ struct FRequenceInputAction
 	GENERATED_USTRUCT_BODY()
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FString ActionName = "";
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FString KeyString = "";
+	//Used to be an FString. Old saves still load, the engine converts tagged string properties to names.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FName ActionName;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FKey Key;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	uint32 bShift : 1;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	uint32 bCtrl : 1;
@@ -112,18 +166,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	uint32 bCmd : 1;
 
 	FRequenceInputAction() {}
-	FRequenceInputAction(const FString InActionName, const FKey InKey, const bool bInShift, const bool bInCtrl, const bool bInAlt, const bool bInCmd)
-		: Key(InKey), KeyString(Key.GetDisplayName().ToString()), bShift(bInShift), bCtrl(bInCtrl), bAlt(bInAlt), bCmd(bInCmd)
-	{
-		ActionName = InActionName;
-	}
+	FRequenceInputAction(const FName InActionName, const FKey& InKey, const bool bInShift, const bool bInCtrl, const bool bInAlt, const bool bInCmd)
+		: ActionName(InActionName), Key(InKey), bShift(bInShift), bCtrl(bInCtrl), bAlt(bInAlt), bCmd(bInCmd)
+	{ }
 
 	FRequenceInputAction(const FInputActionKeyMapping& Action)
-		: Key(Action.Key), KeyString(Action.Key.GetDisplayName().ToString()), bShift(Action.bShift), bCtrl(Action.bCtrl), bAlt(Action.bAlt), bCmd(Action.bCmd)
-	{
-		ActionName = Action.ActionName.ToString();
-	}
-	FRequenceInputAction(const FString InActionName) : ActionName(InActionName) 
+		: ActionName(Action.ActionName), Key(Action.Key), bShift(Action.bShift), bCtrl(Action.bCtrl), bAlt(Action.bAlt), bCmd(Action.bCmd)
+	{ }
+	FRequenceInputAction(const FName InActionName) : ActionName(InActionName) 
 	{
 		Key = FKey();
 	}
@@ -135,27 +185,75 @@ struct FRequenceInputAxis
 	GENERATED_USTRUCT_BODY()
 
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FString AxisName = "";
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FString KeyString = "";
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FName AxisName;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	FKey Key;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)	float Scale = 1;
 
 	FRequenceInputAxis() {}
-	FRequenceInputAxis(const FString InAxisName, FKey InKey, float InScale)
-		: AxisName(InAxisName), KeyString(InKey.GetDisplayName().ToString()), Key(InKey), Scale(InScale)
+	FRequenceInputAxis(const FName InAxisName, const FKey& InKey, float InScale)
+		: AxisName(InAxisName), Key(InKey), Scale(InScale)
 	{ }
 
 	FRequenceInputAxis(const FInputAxisKeyMapping& Axis)
-		: Key(Axis.Key), KeyString(Axis.Key.GetDisplayName().ToString()), Scale(Axis.Scale)
-	{
-		AxisName = Axis.AxisName.ToString();
-	}
-	FRequenceInputAxis(const FString InAxisName) : AxisName(InAxisName) 
+		: AxisName(Axis.AxisName), Key(Axis.Key), Scale(Axis.Scale)
+	{ }
+	FRequenceInputAxis(const FName InAxisName) : AxisName(InAxisName) 
 	{
 		Key = FKey();
 	}
 };
 
+//Latency percentiles of one stage of the input pipeline, in milliseconds.
+USTRUCT(BlueprintType)
+struct FRequenceLatencyPercentiles
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly)	int32 NumSamples = 0;
+	UPROPERTY(BlueprintReadOnly)	float P50 = 0.f;
+	UPROPERTY(BlueprintReadOnly)	float P90 = 0.f;
+	UPROPERTY(BlueprintReadOnly)	float P99 = 0.f;
+	UPROPERTY(BlueprintReadOnly)	float Max = 0.f;
+
+	FRequenceLatencyPercentiles() {}
+};
+
+//Input latency of one connected device, over the last 10 to 20 seconds.
+USTRUCT(BlueprintType)
+struct FRequenceDeviceLatency
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly)	FString DeviceName;
+
+	//Upper bound on the time an event waited before Requence polled it. SDL devices only, see FRequenceLatencyTracker::PollWait.
+	UPROPERTY(BlueprintReadOnly)	FRequenceLatencyPercentiles PollWait;
+
+	//Requence receiving the event to handing it to Slate.
+	UPROPERTY(BlueprintReadOnly)	FRequenceLatencyPercentiles ReceiveToDispatch;
+
+	//Handing the event to Slate to the game reporting the bound action or axis fired. Empty unless ReportInputConsumed is used.
+	UPROPERTY(BlueprintReadOnly)	FRequenceLatencyPercentiles DispatchToConsumed;
+
+	FRequenceDeviceLatency() {}
+};
+
+//An action or axis bound to a key, see URequence::GetBindingConflicts.
+USTRUCT(BlueprintType)
+struct FRequenceBindingConflict
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly)	URequenceDevice* Device = nullptr;
+	UPROPERTY(BlueprintReadOnly)	FName Name;
+	UPROPERTY(BlueprintReadOnly)	bool bIsAxis = false;
+
+	FRequenceBindingConflict() {}
+};
+
 /*
 *  Danny de Bruijne (2018)
 *  RequenceStructs
@@ -169,5 +267,5 @@ class URequenceStructs : public UObject
 public:
 	URequenceStructs();
 
-	static float Interpolate(TArray<FVector2D> Points, float val);
+	static float Interpolate(const TArray<FVector2D>& Points, float val);
 };
\ No newline at end of file
@@ -28,8 +28,16 @@ public class RequencePlugin : ModuleRules
   			}
 		);
 
-        PublicAdditionalLibraries.Add("SDL2.lib");
-        PublicDelayLoadDLLs.Add("SDL2.dll");
+        //Windows ships its own SDL, Linux links the engine's
+        if (Target.Platform == UnrealTargetPlatform.Win64 || Target.Platform == UnrealTargetPlatform.Win32)
+        {
+            PublicAdditionalLibraries.Add("SDL2.lib");
+            PublicDelayLoadDLLs.Add("SDL2.dll");
+        }
+        else if (Target.Platform == UnrealTargetPlatform.Linux)
+        {
+            AddEngineThirdPartyPrivateStaticDependencies(Target, "SDL2");
+        }
 
 
         PrivateIncludePaths.AddRange(